@@ -6,56 +6,111 @@
  */
 
 #include "BayesClassifier.h"
-#include <cmath>
+#include <algorithm>
 
-BayesClassifier::BayesClassifier(
-		const std::vector<CovarianceMatrix>& cmInverses,
-		const std::vector<Decimal>& cmDeterminants,
-		const std::vector<RowVector>& meanVectors)
-: cmInverses{cmInverses},
-  cmDeterminants{cmDeterminants},
-  meanVectors{meanVectors}
+// How many points to score together. Small enough that the workspace
+// stays in cache, big enough for the matrix products to pay off.
+constexpr Eigen::Index BayesBatchSize = 256;
+
+BayesClassifier::BayesClassifier(std::vector<GaussianModel> models)
+: models{std::move(models)}
+{
+}
+
+uint8_t BayesClassifier::classify(const PointRef& point) const
+{
+	ClassifierWorkspace workspace{};
+	return classify(point, workspace);
+}
+
+uint8_t BayesClassifier::classify(const PointRef& point,
+		ClassifierWorkspace& workspace) const
+{
+	getScores(point, workspace.scores, workspace.offset);
+
+	// Types start at index 1, but vectors at index 0
+	Eigen::Index best;
+	workspace.scores.maxCoeff(&best);
+	return best + 1;
+}
+
+uint8_t BayesClassifier::classify(const PointRef& point,
+		ClassifierWorkspace& workspace, Decimal& margin) const
+{
+	getScores(point, workspace.scores, workspace.offset);
+	return bestScore(workspace.scores, margin);
+}
+
+/**
+ * Works out how well a point fits each class: the log of the normal
+ * density, give or take some constants that are the same for every
+ * class (and a factor of 2). The class with the highest score wins.
+ */
+ColVector BayesClassifier::getScores(const PointRef& point) const
 {
+	ColVector scores{};
+	ColVector workspace{};
+	getScores(point, scores, workspace);
+	return scores;
 }
 
-uint8_t BayesClassifier::classify(const RowVector& point) const
+/**
+ * Same as getScores(point), but fills in scores instead of returning
+ * them, and works in workspace. Keeping both around between calls saves
+ * allocating them for every point.
+ */
+void BayesClassifier::getScores(const PointRef& point, ColVector& scores,
+		ColVector& workspace) const
 {
-	for (auto a = 0; a < meanVectors.size(); ++a)
+	scores.resize(models.size());
+	for (auto c = 0; c < models.size(); ++c)
 	{
-		auto allPositive = true;
+		scores[c] = -models[c].getLogDeterminant()
+			- models[c].distance(point, workspace);
+	}
+}
 
-		// Compare A to everything else too see if anything is better
-		for (auto b = 0; b < meanVectors.size(); ++b)
-		{
-			if (a == b)
-			{
-				continue;
-			}
-
-			auto value =
-					std::log(cmDeterminants[b]) - std::log(cmDeterminants[a])
-				    + (point - meanVectors[b])
-					   * cmInverses[b]
-					   * (point - meanVectors[b]).transpose()
-			        - (point - meanVectors[a])
-					   * cmInverses[a]
-					   * (point - meanVectors[a]).transpose();
-
-			if (value < 0)
-			{
-				// The point was closer to the other mean, so reject class A
-				allPositive = false;
-				break;
-			}
-		}
+/**
+ * Classifies every row of points, a block at a time.
+ */
+TypeVector BayesClassifier::classifyBatch(const DataRef& points) const
+{
+	TypeVector types(points.rows());
+	for (Eigen::Index start = 0; start < points.rows(); start += BayesBatchSize)
+	{
+		const auto blockSize = std::min(BayesBatchSize,
+				points.rows() - start);
+		DataMatrix scores = getBatchScores(points.middleRows(start, blockSize));
 
-		// If we didn't find anything better, A really is our best class
-		if (allPositive)
+		for (auto i = 0; i < blockSize; ++i)
 		{
-			return a + 1; // Types start at index 1, but vectors at index 0
+			Eigen::Index best;
+			scores.row(i).maxCoeff(&best);
+			types[start + i] = best + 1;
 		}
 	}
+	return types;
+}
 
-	assert(false); // Failed to find a class the point was closest to
-	return 0;
+/**
+ * Works out the scores of every row of points, the same as getScores
+ * does for one point. Row i of the result holds point i's score for
+ * each class.
+ */
+DataMatrix BayesClassifier::getBatchScores(const DataRef& points) const
+{
+	DataMatrix scores(points.rows(), models.size());
+	DataMatrix offsets{};
+	for (auto c = 0; c < models.size(); ++c)
+	{
+		models[c].distances(points, offsets, scores.col(c));
+		scores.col(c).array() = -models[c].getLogDeterminant()
+			- scores.col(c).array();
+	}
+	return scores;
+}
+
+const std::vector<GaussianModel>& BayesClassifier::getModels() const
+{
+	return models;
 }
@@ -9,22 +9,59 @@
 #define BAYESCLASSIFIER_H_
 
 #include "Classifier.h"
+#include "GaussianModel.h"
 #include "Types.h"
+#include <limits>
 #include <vector>
 
 class BayesClassifier: public Classifier
 {
 public:
-	explicit BayesClassifier(
-		const std::vector<CovarianceMatrix>& cmInverses,
-		const std::vector<Decimal>& cmDeterminants,
-		const std::vector<RowVector>& meanVectors);
-	uint8_t classify(const RowVector& point) const override;
+	explicit BayesClassifier(std::vector<GaussianModel> models);
+	uint8_t classify(const PointRef& point) const override;
+	uint8_t classify(const PointRef& point,
+			ClassifierWorkspace& workspace) const override;
+	uint8_t classify(const PointRef& point,
+			ClassifierWorkspace& workspace, Decimal& margin) const override;
+	ColVector getScores(const PointRef& point) const;
+	void getScores(const PointRef& point, ColVector& scores,
+			ColVector& workspace) const;
+	TypeVector classifyBatch(const DataRef& points) const override;
+	DataMatrix getBatchScores(const DataRef& points) const;
+	const std::vector<GaussianModel>& getModels() const;
 
 private:
-	std::vector<CovarianceMatrix> cmInverses;
-	std::vector<Decimal> cmDeterminants;
-	std::vector<RowVector> meanVectors;
+	std::vector<GaussianModel> models;
 };
 
+/**
+ * Picks the type with the highest score, and sets margin to how far
+ * ahead of the runner-up it is. Scores are twice the log of the
+ * likelihood, so a margin of 2 means the winner is e times likelier.
+ */
+template <typename Derived>
+uint8_t bestScore(const Eigen::MatrixBase<Derived>& scores, Decimal& margin)
+{
+	Eigen::Index best = 0;
+	for (auto c = 1; c < scores.rows(); ++c)
+	{
+		if (scores[c] > scores[best])
+		{
+			best = c;
+		}
+	}
+
+	margin = std::numeric_limits<Decimal>::infinity();
+	for (auto c = 0; c < scores.rows(); ++c)
+	{
+		if (c != best && scores[best] - scores[c] < margin)
+		{
+			margin = scores[best] - scores[c];
+		}
+	}
+
+	// Types start at index 1, but vectors at index 0
+	return best + 1;
+}
+
 #endif /* BAYESCLASSIFIER_H_ */
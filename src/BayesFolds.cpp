@@ -0,0 +1,82 @@
+/*
+ * BayesFolds.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#include "BayesFolds.h"
+#include "BayesClassifier.h"
+#include "Dataset.h"
+#include "DatasetView.h"
+#include <cassert>
+
+BayesFolds::BayesFolds(const Dataset& dataset, ClassifierType type)
+: Type{type},
+  dataset{&dataset},
+  statistics{dataset.NumFields, dataset.NumClasses},
+  models{}
+{
+	assert(isBayes(type));
+
+	for (auto i = 1; i <= dataset.NumClasses; ++i)
+	{
+		statistics.add(dataset.getData(), i, dataset.getRowsOfClass(i));
+	}
+
+	models.reserve(dataset.NumClasses);
+	for (auto i = 1; i <= dataset.NumClasses; ++i)
+	{
+		models.push_back(statistics.model(i, type));
+	}
+}
+
+/**
+ * Gives the classifier we'd get by training on every row of the dataset
+ * except the ones in testing.
+ */
+std::shared_ptr<Classifier> BayesFolds::classifier(
+		const DatasetView& testing) const
+{
+	assert(&testing.getDataset() == dataset);
+
+	if (testing.size() == 1)
+	{
+		return leaveOneOut(testing.getRowIndices().front());
+	}
+
+	ClassStatistics fold{dataset->NumFields, dataset->NumClasses};
+	for (auto i = 1; i <= dataset->NumClasses; ++i)
+	{
+		fold.add(dataset->getData(), i, testing.getRowsOfClass(i));
+	}
+
+	auto training = statistics;
+	training.subtract(fold);
+	return training.classifier(Type);
+}
+
+/**
+ * Gives the classifier trained on everything but one row. Only the
+ * row's class changes, and its model can usually just be updated.
+ */
+std::shared_ptr<Classifier> BayesFolds::leaveOneOut(size_t row) const
+{
+	const auto type = dataset->getType(row);
+	const auto c = type - 1;
+
+	auto models = this->models;
+	if (models[c].removePoint(dataset->getData().row(row),
+			statistics.getCount(type)))
+	{
+		return std::make_shared<BayesClassifier>(std::move(models));
+	}
+
+	ClassStatistics removed{dataset->NumFields, dataset->NumClasses};
+	removed.add(dataset->getData(), type, {row});
+	auto training = statistics;
+	training.subtract(removed);
+
+	models[c] = training.model(type, Type);
+	return std::make_shared<BayesClassifier>(std::move(models));
+}
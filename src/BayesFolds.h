@@ -0,0 +1,47 @@
+/*
+ * BayesFolds.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#ifndef BAYESFOLDS_H_
+#define BAYESFOLDS_H_
+
+#include "ClassStatistics.h"
+#include "Classifier.h"
+#include "GaussianModel.h"
+#include "Types.h"
+#include <memory>
+#include <vector>
+class Dataset;
+class DatasetView;
+
+/**
+ * Trains Bayes classifiers for cross-validation without starting from
+ * scratch on every fold. The statistics of the whole dataset are worked
+ * out once, and each fold's training statistics are found by taking the
+ * testing rows back out of them.
+ *
+ * When only one row is left out, only that row's class changes, and its
+ * model is updated in place instead of being fit again. For optimal
+ * Bayes that's a rank one downdate of its Cholesky factor.
+ */
+class BayesFolds
+{
+public:
+	const ClassifierType Type;
+
+public:
+	explicit BayesFolds(const Dataset& dataset, ClassifierType type);
+	std::shared_ptr<Classifier> classifier(const DatasetView& testing) const;
+
+private:
+	std::shared_ptr<Classifier> leaveOneOut(size_t row) const;
+
+	const Dataset* dataset;
+	ClassStatistics statistics;
+	std::vector<GaussianModel> models;
+};
+
+#endif /* BAYESFOLDS_H_ */
@@ -0,0 +1,323 @@
+/*
+ * BinaryDataset.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#include "BinaryDataset.h"
+#include "Dataset.h"
+#include "DatasetStream.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+static const char BinaryDatasetMagic[8] = "CLSDSET";
+
+/**
+ * Rounds an offset up to the start of the next section.
+ */
+static uint64_t align(uint64_t offset)
+{
+	return (offset + BinaryDatasetAlignment - 1)
+			/ BinaryDatasetAlignment * BinaryDatasetAlignment;
+}
+
+/**
+ * Pads the file with zeros until it reaches the given offset.
+ */
+static void padTo(std::ofstream& out, uint64_t offset)
+{
+	static const char zeros[BinaryDatasetAlignment] = {};
+	auto position = static_cast<uint64_t>(out.tellp());
+	assert(position <= offset && offset - position < BinaryDatasetAlignment);
+	out.write(zeros, offset - position);
+}
+
+void writeBinaryDataset(const Dataset& dataset, std::string filename)
+{
+	const auto& names = dataset.getNames();
+	const auto& types = dataset.getTypes();
+	const auto& data = dataset.getData();
+
+	// Work out where the names will go
+	std::vector<uint64_t> nameOffsets{};
+	nameOffsets.reserve(names.size() + 1);
+	uint64_t namesLength = 0;
+	for (const auto& name : names)
+	{
+		nameOffsets.push_back(namesLength);
+		namesLength += name.size();
+	}
+	nameOffsets.push_back(namesLength);
+
+	// Lay out the sections of the file
+	BinaryDatasetHeader header{};
+	std::memcpy(header.magic, BinaryDatasetMagic, sizeof(header.magic));
+	header.version = BinaryDatasetVersion;
+	header.decimalSize = sizeof(Decimal);
+	header.numRows = dataset.size();
+	header.numFields = dataset.NumFields;
+	header.numClasses = dataset.NumClasses;
+	header.dataOffset = align(sizeof(header));
+	header.typesOffset = align(header.dataOffset
+			+ header.numRows * header.numFields * sizeof(Decimal));
+	header.nameOffsetsOffset = align(header.typesOffset + header.numRows);
+	header.namesOffset = align(header.nameOffsetsOffset
+			+ nameOffsets.size() * sizeof(uint64_t));
+	header.fileSize = header.namesOffset + namesLength;
+
+	auto out = std::ofstream{filename, std::ios::binary | std::ios::trunc};
+	if (!out.is_open())
+	{
+		throw std::runtime_error{"Can't open " + filename + " for writing"};
+	}
+
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	// Our data is already column-major, so it can be written in one go
+	padTo(out, header.dataOffset);
+	out.write(reinterpret_cast<const char*>(data.data()),
+			data.size() * sizeof(Decimal));
+
+	padTo(out, header.typesOffset);
+	out.write(reinterpret_cast<const char*>(types.data()), types.size());
+
+	padTo(out, header.nameOffsetsOffset);
+	out.write(reinterpret_cast<const char*>(nameOffsets.data()),
+			nameOffsets.size() * sizeof(uint64_t));
+
+	padTo(out, header.namesOffset);
+	for (const auto& name : names)
+	{
+		out.write(name.data(), name.size());
+	}
+
+	if (!out.good())
+	{
+		throw std::runtime_error{"Couldn't write " + filename};
+	}
+	assert(static_cast<uint64_t>(out.tellp()) == header.fileSize);
+}
+
+/**
+ * Checks that a section of rows x cols values, each size bytes, starts
+ * on a section boundary after the header and ends inside the file.
+ * Written so that no amount of garbage in the header can overflow.
+ */
+static bool sectionFits(uint64_t offset, uint64_t rows, uint64_t cols,
+		size_t size, uint64_t fileSize)
+{
+	if (offset < sizeof(BinaryDatasetHeader)
+			|| offset % BinaryDatasetAlignment != 0 || offset > fileSize)
+	{
+		return false;
+	}
+	const auto room = (fileSize - offset) / size;
+	return rows == 0 || cols <= room / rows;
+}
+
+/**
+ * Checks that a file is a dataset we can use: the right format, written
+ * with the same Decimal width we were built with, with every section
+ * inside the file, every name inside the names section and every type
+ * one of the dataset's classes. Nothing in a file that passes can send
+ * a loaded dataset outside of it.
+ */
+static bool isUsable(const MappedFile& file)
+{
+	BinaryDatasetHeader header;
+	if (file.size() < sizeof(header))
+	{
+		return false;
+	}
+	std::memcpy(&header, file.begin(), sizeof(header));
+
+	if (std::memcmp(header.magic, BinaryDatasetMagic,
+				sizeof(header.magic)) != 0
+			|| header.version != BinaryDatasetVersion
+			|| header.decimalSize != sizeof(Decimal)
+			|| header.fileSize != file.size())
+	{
+		return false;
+	}
+
+	// Types are a byte, starting at 1. Once the types fit, there are
+	// fewer rows than bytes in the file, so numRows + 1 can't overflow.
+	const auto fileSize = header.fileSize;
+	if (header.numClasses == 0 || header.numClasses >= NoType
+			|| !sectionFits(header.dataOffset, header.numRows,
+					header.numFields, sizeof(Decimal), fileSize)
+			|| !sectionFits(header.typesOffset, 1, header.numRows,
+					sizeof(uint8_t), fileSize)
+			|| !sectionFits(header.nameOffsetsOffset, 1, header.numRows + 1,
+					sizeof(uint64_t), fileSize)
+			|| !sectionFits(header.namesOffset, 0, 0, sizeof(char),
+					fileSize))
+	{
+		return false;
+	}
+
+	const auto* types = reinterpret_cast<const uint8_t*>(
+			file.begin() + header.typesOffset);
+	for (uint64_t i = 0; i < header.numRows; ++i)
+	{
+		if (types[i] < 1 || types[i] > header.numClasses)
+		{
+			return false;
+		}
+	}
+
+	// Names are in order, so if the offsets never go backwards and the
+	// last one is inside the section, every name is
+	const auto* nameOffsets = reinterpret_cast<const uint64_t*>(
+			file.begin() + header.nameOffsetsOffset);
+	for (uint64_t i = 0; i < header.numRows; ++i)
+	{
+		if (nameOffsets[i] > nameOffsets[i + 1])
+		{
+			return false;
+		}
+	}
+	return nameOffsets[header.numRows] <= fileSize - header.namesOffset;
+}
+
+/**
+ * Reads the header of a binary dataset, after checking that it's a file
+ * we can use. Files we can't throw std::runtime_error.
+ */
+static BinaryDatasetHeader readHeader(const MappedFile& file,
+		const std::string& filename)
+{
+	if (!isUsable(file))
+	{
+		throw std::runtime_error{filename
+			+ " isn't a binary dataset this build can read"};
+	}
+
+	BinaryDatasetHeader header;
+	std::memcpy(&header, file.begin(), sizeof(header));
+	return header;
+}
+
+/**
+ * Checks whether readBinaryDataset can load a file. Files written by a
+ * build with a different precision can't be, for one, and neither can
+ * ones that have been cut short or aren't binary datasets at all.
+ */
+bool isBinaryDatasetReadable(std::string filename)
+{
+	try
+	{
+		MappedFile file{filename};
+		return isUsable(file);
+	}
+	catch (const std::runtime_error&)
+	{
+		return false; // Can't even open it
+	}
+}
+
+/**
+ * Loads a binary dataset by memory-mapping it. The data and types are
+ * used straight from the mapping instead of being copied, so loading
+ * takes about as long as reading the names. Files that aren't binary
+ * datasets we can use throw std::runtime_error.
+ */
+Dataset readBinaryDataset(std::string filename)
+{
+	auto file = std::make_shared<const MappedFile>(filename);
+	const auto header = readHeader(*file, filename);
+
+	// Rebuild the names
+	auto nameOffsets = reinterpret_cast<const uint64_t*>(
+			file->begin() + header.nameOffsetsOffset);
+	auto nameChars = file->begin() + header.namesOffset;
+	std::vector<std::string> names{};
+	names.reserve(header.numRows);
+	for (auto i = 0; i < header.numRows; ++i)
+	{
+		names.emplace_back(nameChars + nameOffsets[i],
+				nameOffsets[i + 1] - nameOffsets[i]);
+	}
+
+	auto types = reinterpret_cast<const uint8_t*>(
+			file->begin() + header.typesOffset);
+	auto data = reinterpret_cast<const Decimal*>(
+			file->begin() + header.dataOffset);
+
+	return Dataset{std::move(names), std::move(file), types, data,
+		header.numRows, header.numFields, header.numClasses};
+}
+
+/**
+ * Streams a binary dataset a batch of rows at a time.
+ */
+class BinaryDatasetStream : public DatasetStream
+{
+public:
+	explicit BinaryDatasetStream(std::unique_ptr<MappedFile> file,
+			const BinaryDatasetHeader& header, size_t batchSize);
+	bool next(DatasetBatch& batch) override;
+
+private:
+	std::unique_ptr<MappedFile> file;
+	TypeMap types;
+	DataMap data;
+	size_t nextRow;
+};
+
+BinaryDatasetStream::BinaryDatasetStream(std::unique_ptr<MappedFile> file,
+		const BinaryDatasetHeader& header, size_t batchSize)
+: DatasetStream{header.numFields, header.numClasses, batchSize},
+  file{std::move(file)},
+  types{reinterpret_cast<const uint8_t*>(
+		  this->file->begin() + header.typesOffset),
+	  static_cast<Eigen::Index>(header.numRows)},
+  data{reinterpret_cast<const Decimal*>(
+		  this->file->begin() + header.dataOffset),
+	  static_cast<Eigen::Index>(header.numRows),
+	  static_cast<Eigen::Index>(header.numFields)},
+  nextRow{0}
+{
+}
+
+bool BinaryDatasetStream::next(DatasetBatch& batch)
+{
+	if (nextRow >= data.rows())
+	{
+		return false;
+	}
+
+	const auto numRows = std::min<size_t>(BatchSize, data.rows() - nextRow);
+	batch.types = types.segment(nextRow, numRows);
+	batch.data = data.middleRows(nextRow, numRows);
+
+	// We won't look at these rows again, so they don't need to stay
+	// in memory. Every column is stored separately.
+	for (auto j = 0; j < data.cols(); ++j)
+	{
+		auto column = reinterpret_cast<const char*>(data.col(j).data());
+		file->discard(column + nextRow * sizeof(Decimal),
+				column + (nextRow + numRows) * sizeof(Decimal));
+	}
+	file->discard(reinterpret_cast<const char*>(types.data() + nextRow),
+			reinterpret_cast<const char*>(types.data() + nextRow + numRows));
+
+	nextRow += numRows;
+	return true;
+}
+
+std::unique_ptr<DatasetStream> streamBinaryDataset(std::string filename,
+		size_t batchSize)
+{
+	auto file = std::make_unique<MappedFile>(filename);
+	const auto header = readHeader(*file, filename);
+	return std::make_unique<BinaryDatasetStream>(std::move(file), header,
+			batchSize);
+}
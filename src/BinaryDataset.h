@@ -0,0 +1,59 @@
+/*
+ * BinaryDataset.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#ifndef BINARYDATASET_H_
+#define BINARYDATASET_H_
+
+#include "Types.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+class Dataset;
+class DatasetStream;
+
+/**
+ * Binary dataset files hold everything in a Dataset, laid out so the
+ * file can be memory-mapped and used in place:
+ *
+ *   header       BinaryDatasetHeader
+ *   data         numRows x numFields Decimals, column-major
+ *   types        numRows bytes
+ *   name offsets numRows + 1 uint64_t offsets into the name characters
+ *   names        every name, one after another
+ *
+ * Every section starts on a BinaryDatasetAlignment boundary. Files are
+ * written in the byte order and Decimal width of the machine writing
+ * them, and can only be read back on a matching machine.
+ *
+ * Reading or streaming a file checks every section first, and throws
+ * std::runtime_error for anything it can't use.
+ */
+constexpr uint32_t BinaryDatasetVersion = 1;
+constexpr size_t BinaryDatasetAlignment = 64;
+
+struct BinaryDatasetHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t decimalSize;
+	uint64_t numRows;
+	uint64_t numFields;
+	uint64_t numClasses;
+	uint64_t dataOffset;
+	uint64_t typesOffset;
+	uint64_t nameOffsetsOffset;
+	uint64_t namesOffset;
+	uint64_t fileSize;
+};
+
+void writeBinaryDataset(const Dataset& dataset, std::string filename);
+Dataset readBinaryDataset(std::string filename);
+bool isBinaryDatasetReadable(std::string filename);
+std::unique_ptr<DatasetStream> streamBinaryDataset(std::string filename,
+		size_t batchSize);
+
+#endif /* BINARYDATASET_H_ */
@@ -0,0 +1,61 @@
+/*
+ * CascadeClassifier.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#include "CascadeClassifier.h"
+#include <cassert>
+
+CascadeClassifier::CascadeClassifier(std::shared_ptr<const Classifier> cheap,
+		std::shared_ptr<const Classifier> expensive,
+		Decimal threshold)
+: Threshold{threshold},
+  cheap{std::move(cheap)},
+  expensive{std::move(expensive)},
+  numClassified{0},
+  numEscalated{0}
+{
+	assert(this->cheap && this->expensive);
+	assert(threshold >= 0);
+}
+
+uint8_t CascadeClassifier::classify(const PointRef& point) const
+{
+	ClassifierWorkspace workspace{};
+	return classify(point, workspace);
+}
+
+uint8_t CascadeClassifier::classify(const PointRef& point,
+		ClassifierWorkspace& workspace) const
+{
+	++numClassified;
+
+	Decimal margin;
+	auto type = cheap->classify(point, workspace, margin);
+	if (type != NoType && margin >= Threshold)
+	{
+		return type;
+	}
+
+	++numEscalated;
+	return expensive->classify(point, workspace);
+}
+
+/**
+ * How many of the points classified so far had to be passed on to the
+ * expensive classifier, as a fraction.
+ */
+double CascadeClassifier::getEscalatedFraction() const
+{
+	const auto classified = numClassified.load();
+	return classified == 0
+		? 0 : numEscalated.load() / static_cast<double>(classified);
+}
+
+void CascadeClassifier::resetCounts()
+{
+	numClassified = 0;
+	numEscalated = 0;
+}
@@ -0,0 +1,54 @@
+/*
+ * CascadeClassifier.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#ifndef CASCADECLASSIFIER_H_
+#define CASCADECLASSIFIER_H_
+
+#include "Classifier.h"
+#include "Types.h"
+#include <atomic>
+#include <memory>
+
+/**
+ * Classifies points with a cheap classifier first, and only asks an
+ * expensive one when the cheap one isn't sure. Most points are easy, so
+ * on average this is nearly as fast as the cheap classifier and nearly
+ * as accurate as the expensive one.
+ *
+ * The cheap classifier is sure when the margin it gives is at least the
+ * threshold. For Bayes classifiers (fixed-size or not) that's how far
+ * the best class's score beats the runner-up's, so a threshold of 2
+ * means the best class has to be e times likelier than any other. Any
+ * other kind of classifier is only unsure when it can't decide at all.
+ */
+class CascadeClassifier: public Classifier
+{
+public:
+	const Decimal Threshold;
+
+public:
+	explicit CascadeClassifier(std::shared_ptr<const Classifier> cheap,
+			std::shared_ptr<const Classifier> expensive,
+			Decimal threshold);
+	using Classifier::classify;
+	uint8_t classify(const PointRef& point) const override;
+	uint8_t classify(const PointRef& point,
+			ClassifierWorkspace& workspace) const override;
+	double getEscalatedFraction() const;
+	void resetCounts();
+
+private:
+	std::shared_ptr<const Classifier> cheap;
+	std::shared_ptr<const Classifier> expensive;
+
+	// Counted as we go, so these can be updated by any thread that's
+	// classifying
+	mutable std::atomic<size_t> numClassified;
+	mutable std::atomic<size_t> numEscalated;
+};
+
+#endif /* CASCADECLASSIFIER_H_ */
@@ -0,0 +1,291 @@
+/*
+ * ClassStatistics.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#include "ClassStatistics.h"
+#include "BayesClassifier.h"
+#include "Dataset.h"
+#include "DatasetStream.h"
+#include <algorithm>
+#include <cassert>
+
+// How many rows to gather up before adding them to the statistics
+constexpr Eigen::Index StatisticsBlockSize = 256;
+
+ClassStatistics::ClassStatistics(size_t numFields, size_t numClasses)
+: NumFields{numFields},
+  NumClasses{numClasses},
+  counts(numClasses, 0),
+  means(numClasses, AccumulatorVector::Zero(numFields)),
+  scatters(numClasses, AccumulatorMatrix::Zero(numFields, numFields)),
+  block{}
+{
+}
+
+/**
+ * Adds some rows of training data to the statistics.
+ *
+ * The rows are worked through in blocks small enough to stay in cache,
+ * sorting each block by class as we go, so all the classes are done in
+ * one pass over the data.
+ */
+void ClassStatistics::add(const DataRef& data, const TypeRef& types)
+{
+	assert(data.rows() == types.rows());
+	assert(data.cols() == NumFields);
+
+	std::vector<std::vector<size_t>> classRows(NumClasses);
+	for (Eigen::Index start = 0; start < data.rows();
+			start += StatisticsBlockSize)
+	{
+		const auto blockEnd = std::min(start + StatisticsBlockSize,
+				data.rows());
+
+		for (auto& rows : classRows)
+		{
+			rows.clear();
+		}
+		for (auto i = start; i < blockEnd; ++i)
+		{
+			assert(types[i] >= 1 && types[i] <= NumClasses);
+			classRows[types[i] - 1].push_back(i);
+		}
+
+		for (auto c = 0; c < NumClasses; ++c)
+		{
+			merge(c, data, cbegin(classRows[c]), cend(classRows[c]));
+		}
+	}
+}
+
+/**
+ * Adds the given rows of data, which all belong to one class, to the
+ * statistics.
+ */
+void ClassStatistics::add(const DataRef& data, uint8_t type,
+		const std::vector<size_t>& rows)
+{
+	assert(type >= 1 && type <= NumClasses);
+	assert(data.cols() == NumFields);
+
+	for (size_t start = 0; start < rows.size(); start += StatisticsBlockSize)
+	{
+		const auto blockEnd = std::min<size_t>(start + StatisticsBlockSize,
+				rows.size());
+		merge(type - 1, data, cbegin(rows) + start, cbegin(rows) + blockEnd);
+	}
+}
+
+/**
+ * Adds every remaining batch of a stream to the statistics.
+ */
+void ClassStatistics::add(DatasetStream& stream)
+{
+	assert(stream.NumFields == NumFields);
+	assert(stream.NumClasses == NumClasses);
+
+	DatasetBatch batch{};
+	while (stream.next(batch))
+	{
+		add(batch.data, batch.types);
+	}
+}
+
+/**
+ * Takes some points back out of the statistics. other has to have been
+ * built from rows that were added to these statistics, so this is how
+ * we get the statistics of a training fold from those of the whole
+ * dataset and the testing fold.
+ *
+ * This is the merge below run backwards.
+ */
+void ClassStatistics::subtract(const ClassStatistics& other)
+{
+	assert(other.NumFields == NumFields);
+	assert(other.NumClasses == NumClasses);
+
+	for (auto c = 0; c < NumClasses; ++c)
+	{
+		assert(other.counts[c] <= counts[c]);
+		if (other.counts[c] == 0)
+		{
+			continue;
+		}
+
+		const auto remainingCount = counts[c] - other.counts[c];
+		if (remainingCount == 0)
+		{
+			counts[c] = 0;
+			means[c].setZero();
+			scatters[c].setZero();
+			continue;
+		}
+
+		const auto totalCount = static_cast<Accumulator>(counts[c]);
+		const auto oldCount = static_cast<Accumulator>(remainingCount);
+		const auto newCount = static_cast<Accumulator>(other.counts[c]);
+
+		AccumulatorVector oldMeans = (means[c] * totalCount
+				- other.means[c] * newCount) / oldCount;
+		AccumulatorVector delta = other.means[c] - oldMeans;
+
+		scatters[c] -= other.scatters[c];
+		scatters[c].selfadjointView<Eigen::Lower>().rankUpdate(
+				delta.transpose(), -oldCount * newCount / totalCount);
+		means[c] = oldMeans;
+		counts[c] = remainingCount;
+	}
+}
+
+/**
+ * Combines the given rows of data, which can't be more than a block's
+ * worth, with what we already know about the class.
+ *
+ * Adding up raw sums of squares loses almost all its precision when the
+ * mean is large compared to the spread, so instead we work out the mean
+ * and scatter of the new points on their own and then combine the two
+ * using the pairwise update from Chan, Golub and LeVeque.
+ *
+ * Scatter matrices are symmetric, so only their lower half is kept up
+ * to date.
+ */
+void ClassStatistics::merge(size_t classIndex, const DataRef& data,
+		std::vector<size_t>::const_iterator first,
+		std::vector<size_t>::const_iterator last)
+{
+	const auto numRows = static_cast<Eigen::Index>(last - first);
+	assert(numRows <= StatisticsBlockSize);
+	if (numRows == 0)
+	{
+		return;
+	}
+
+	// Copy the rows into the block, which we reuse so we're not
+	// allocating a new one every time
+	if (block.rows() == 0)
+	{
+		block.resize(StatisticsBlockSize, NumFields);
+	}
+	auto classData = block.topRows(numRows);
+	for (auto i = 0; i < numRows; ++i)
+	{
+		classData.row(i) = data.row(first[i]).cast<Accumulator>();
+	}
+
+	const auto oldCount = static_cast<Accumulator>(counts[classIndex]);
+	const auto newCount = static_cast<Accumulator>(numRows);
+	const auto totalCount = oldCount + newCount;
+
+	AccumulatorVector newMeans = classData.colwise().mean();
+	classData.rowwise() -= newMeans;
+	AccumulatorVector delta = newMeans - means[classIndex];
+
+	auto scatter = scatters[classIndex].selfadjointView<Eigen::Lower>();
+	scatter.rankUpdate(classData.transpose());
+	scatter.rankUpdate(delta.transpose(), oldCount * newCount / totalCount);
+	means[classIndex] += delta * (newCount / totalCount);
+	counts[classIndex] += numRows;
+}
+
+size_t ClassStatistics::getCount(uint8_t type) const
+{
+	assert(type >= 1 && type <= NumClasses);
+	return counts[type - 1];
+}
+
+RowVector ClassStatistics::getMeans(uint8_t type) const
+{
+	assert(type >= 1 && type <= NumClasses);
+	return means[type - 1].cast<Decimal>();
+}
+
+/**
+ * Gives the same covariance matrix Dataset::getCovarianceMatrix would
+ * for the subset of the data belonging to one class.
+ */
+CovarianceMatrix ClassStatistics::getCovarianceMatrix(uint8_t type,
+		ClassifierType ctype) const
+{
+	assert(type >= 1 && type <= NumClasses);
+
+	if (ctype == ClassifierType::LINEAR)
+	{
+		return CovarianceMatrix::Identity(NumFields, NumFields);
+	}
+
+	AccumulatorMatrix scatter = scatters[type - 1]
+		.selfadjointView<Eigen::Lower>();
+	CovarianceMatrix cov = (scatter
+		/ static_cast<Accumulator>(counts[type - 1] - 1)).cast<Decimal>();
+
+	if (ctype == ClassifierType::OPTIMAL)
+	{
+		return cov;
+	}
+	else
+	{
+		assert(ctype == ClassifierType::NAIVE);
+		return cov.diagonal().asDiagonal();
+	}
+}
+
+/**
+ * The variance of each field, for the points belonging to one class.
+ * Same as the diagonal of its covariance matrix, without working out
+ * the rest of it.
+ */
+RowVector ClassStatistics::getVariances(uint8_t type) const
+{
+	assert(type >= 1 && type <= NumClasses);
+	return (scatters[type - 1].diagonal().transpose()
+		/ static_cast<Accumulator>(counts[type - 1] - 1)).cast<Decimal>();
+}
+
+/**
+ * Fits a normal distribution to the points of one class, with the kind
+ * of covariance matrix the classifier type calls for.
+ */
+GaussianModel ClassStatistics::model(uint8_t type, ClassifierType ctype) const
+{
+	assert(type >= 1 && type <= NumClasses);
+
+	// End the program if we have a size-0 subclass
+	assert(counts[type - 1] != 0);
+
+	switch (ctype)
+	{
+	case ClassifierType::OPTIMAL:
+		return GaussianModel{getMeans(type),
+			getCovarianceMatrix(type, ctype)};
+	case ClassifierType::NAIVE:
+		return GaussianModel{getMeans(type),
+			DiagonalMatrix{getVariances(type).transpose()}};
+	case ClassifierType::LINEAR:
+		return GaussianModel{getMeans(type)};
+	default:
+		assert(false); // Decision trees aren't normal distributions
+		return GaussianModel{getMeans(type)};
+	}
+}
+
+/**
+ * Builds a Bayes classifier from the statistics.
+ */
+std::shared_ptr<Classifier> ClassStatistics::classifier(
+		ClassifierType type) const
+{
+	assert(isBayes(type));
+
+	std::vector<GaussianModel> models{};
+	models.reserve(NumClasses);
+
+	for (auto i = 1; i <= NumClasses; ++i)
+	{
+		models.push_back(model(i, type));
+	}
+
+	return std::make_shared<BayesClassifier>(std::move(models));
+}
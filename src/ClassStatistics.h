@@ -0,0 +1,58 @@
+/*
+ * ClassStatistics.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#ifndef CLASSSTATISTICS_H_
+#define CLASSSTATISTICS_H_
+
+#include "Classifier.h"
+#include "GaussianModel.h"
+#include "Types.h"
+#include <memory>
+#include <vector>
+class DatasetStream;
+
+/**
+ * Everything a Bayes classifier needs to know about the training data:
+ * how many points each class has, their mean, and their scatter matrix
+ * (the sum of the outer products of each point's offset from the mean).
+ *
+ * Rows can be added a batch at a time, so the training data never has
+ * to be in memory all at once.
+ */
+class ClassStatistics
+{
+public:
+	const size_t NumFields;
+	const size_t NumClasses;
+
+public:
+	explicit ClassStatistics(size_t numFields, size_t numClasses);
+	void add(const DataRef& data, const TypeRef& types);
+	void add(const DataRef& data, uint8_t type,
+			const std::vector<size_t>& rows);
+	void add(DatasetStream& stream);
+	void subtract(const ClassStatistics& other);
+	size_t getCount(uint8_t type) const;
+	RowVector getMeans(uint8_t type) const;
+	CovarianceMatrix getCovarianceMatrix(uint8_t type,
+			ClassifierType ctype) const;
+	RowVector getVariances(uint8_t type) const;
+	GaussianModel model(uint8_t type, ClassifierType ctype) const;
+	std::shared_ptr<Classifier> classifier(ClassifierType type) const;
+
+private:
+	void merge(size_t classIndex, const DataRef& data,
+			std::vector<size_t>::const_iterator first,
+			std::vector<size_t>::const_iterator last);
+
+	std::vector<size_t> counts;
+	std::vector<AccumulatorVector> means;
+	std::vector<AccumulatorMatrix> scatters;
+	AccumulatorMatrix block;
+};
+
+#endif /* CLASSSTATISTICS_H_ */
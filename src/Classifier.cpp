@@ -4,3 +4,44 @@
  *  Created on: Mar 19, 2016
  *      Author: derek
  */
+
+#include "Classifier.h"
+
+/**
+ * Classifies a point using workspace for scratch space. Classifiers that
+ * need some should override this; the rest can ignore it.
+ */
+uint8_t Classifier::classify(const PointRef& point,
+		ClassifierWorkspace&) const
+{
+	return classify(point);
+}
+
+/**
+ * Classifies a point, and sets margin to how sure the classifier is of
+ * the answer: the bigger it is, the surer. Classifiers that don't score
+ * the classes are sure of any type they decide on, and have no idea
+ * when they can't decide; ones that do should override this.
+ */
+uint8_t Classifier::classify(const PointRef& point,
+		ClassifierWorkspace& workspace, Decimal& margin) const
+{
+	auto type = classify(point, workspace);
+	margin = type == NoType ? 0 : std::numeric_limits<Decimal>::infinity();
+	return type;
+}
+
+/**
+ * Classifies every row of points. Classifiers that can do a whole block
+ * of points faster than one at a time should override this.
+ */
+TypeVector Classifier::classifyBatch(const DataRef& points) const
+{
+	TypeVector types(points.rows());
+	ClassifierWorkspace workspace{};
+	for (auto i = 0; i < points.rows(); ++i)
+	{
+		types[i] = classify(points.row(i), workspace);
+	}
+	return types;
+}
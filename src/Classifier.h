@@ -10,11 +10,29 @@
 
 #include "Types.h"
 #include <cstdint>
+#include <limits>
+
+/**
+ * Scratch space a classifier can work in while classifying a point, so
+ * it doesn't have to allocate its own every time. Pass the same one to
+ * every call (one per thread); once it has grown to fit, classifying
+ * doesn't allocate anything.
+ */
+struct ClassifierWorkspace
+{
+	ColVector offset;
+	ColVector scores;
+};
 
 class Classifier
 {
 public:
-	virtual uint8_t classify(const RowVector& point) const = 0;
+	virtual uint8_t classify(const PointRef& point) const = 0;
+	virtual uint8_t classify(const PointRef& point,
+			ClassifierWorkspace& workspace) const;
+	virtual uint8_t classify(const PointRef& point,
+			ClassifierWorkspace& workspace, Decimal& margin) const;
+	virtual TypeVector classifyBatch(const DataRef& points) const;
 	virtual ~Classifier() = default;
 };
 
@@ -0,0 +1,253 @@
+/*
+ * ContingencyTable.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#include "ContingencyTable.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+constexpr size_t ContingencyTable::NumValues;
+
+// Gains closer together than this are the same gain, give or take
+// rounding
+constexpr double GainTolerance = 1e-12;
+
+/**
+ * Works out a table of n log2(n) for every n up to maxRows.
+ */
+static std::vector<double> nLog2nTable(size_t maxRows)
+{
+	std::vector<double> table(maxRows + 1, 0);
+	for (auto n = 1; n <= maxRows; ++n)
+	{
+		table[n] = n * std::log2(static_cast<double>(n));
+	}
+	return table;
+}
+
+/**
+ * numTypes has to be bigger than any type the rows can have.
+ */
+ContingencyTable::ContingencyTable(size_t maxRows, size_t numTypes)
+: MaxRows{maxRows},
+  NumTypes{numTypes},
+  nLog2n{std::make_shared<const std::vector<double>>(nLog2nTable(maxRows))},
+  typeCounts(numTypes, 0),
+  leftCounts(numTypes, 0),
+  valueCounts{},
+  counts(numTypes * NumValues, 0)
+{
+}
+
+/**
+ * The entropy of the types of the given rows, the same as the entropy
+ * function works out.
+ */
+double ContingencyTable::entropy(const TypeRef& types,
+		std::vector<size_t>::const_iterator first,
+		std::vector<size_t>::const_iterator last)
+{
+	const auto numRows = static_cast<size_t>(last - first);
+	assert(numRows > 0 && numRows <= MaxRows);
+	const auto& nLog2n = *this->nLog2n;
+
+	for (auto row = first; row != last; ++row)
+	{
+		assert(types[*row] < NumTypes);
+		++typeCounts[types[*row]];
+	}
+
+	// Splitting the n log n terms up this way means a single class
+	// comes out as exactly 0
+	auto ret = nLog2n[numRows];
+	for (auto& count : typeCounts)
+	{
+		ret -= nLog2n[count];
+		count = 0;
+	}
+	return ret / numRows;
+}
+
+/**
+ * How many bits you will save by knowing the value of a column, the
+ * same as the gain function works out.
+ */
+double ContingencyTable::gain(const TypeRef& types, const DataRef& data,
+		size_t column, std::vector<size_t>::const_iterator first,
+		std::vector<size_t>::const_iterator last)
+{
+	const auto numRows = static_cast<size_t>(last - first);
+	assert(numRows > 0 && numRows <= MaxRows);
+	const auto& nLog2n = *this->nLog2n;
+
+	size_t minValue = NumValues;
+	size_t maxValue = 0;
+	for (auto row = first; row != last; ++row)
+	{
+		const auto value = static_cast<uint8_t>(data(*row, column));
+		const auto type = types[*row];
+		assert(value == data(*row, column));
+		assert(type < NumTypes);
+
+		++counts[type * NumValues + value];
+		++valueCounts[value];
+		++typeCounts[type];
+		minValue = std::min<size_t>(minValue, value);
+		maxValue = std::max<size_t>(maxValue, value);
+	}
+
+	// What knowing the value tells us
+	auto splitTerm = nLog2n[numRows];
+	for (auto value = minValue; value <= maxValue; ++value)
+	{
+		splitTerm -= nLog2n[valueCounts[value]];
+		valueCounts[value] = 0;
+	}
+
+	// Less what it doesn't tell us about each class. Done a class at a
+	// time so that a column with only one value comes out as exactly 0.
+	auto typeTerm = 0.0;
+	for (auto type = 0; type < NumTypes; ++type)
+	{
+		if (typeCounts[type] == 0)
+		{
+			continue;
+		}
+
+		auto* typeValueCounts = counts.data() + type * NumValues;
+		auto term = nLog2n[typeCounts[type]];
+		for (auto value = minValue; value <= maxValue; ++value)
+		{
+			term -= nLog2n[typeValueCounts[value]];
+			typeValueCounts[value] = 0;
+		}
+		typeTerm += term;
+		typeCounts[type] = 0;
+	}
+
+	return (splitTerm - typeTerm) / numRows;
+}
+
+/**
+ * Finds the threshold to split some rows on that gains the most
+ * information, out of the points halfway between each pair of values
+ * next to each other. The rows have to be sorted by the column. Gives a
+ * gain of 0 if every row has the same value.
+ *
+ * The gain of each split is worked out from scratch from the counts,
+ * the same way gain does, rather than updating a running total, so
+ * rounding doesn't build up over the sweep. Splits that tie go to the
+ * first one.
+ */
+ThresholdSplit ContingencyTable::bestThreshold(const TypeRef& types,
+		const DataRef& data, size_t column,
+		std::vector<size_t>::const_iterator first,
+		std::vector<size_t>::const_iterator last)
+{
+	const auto numRows = static_cast<size_t>(last - first);
+	assert(numRows > 0 && numRows <= MaxRows);
+	const auto& nLog2n = *this->nLog2n;
+
+	for (auto row = first; row != last; ++row)
+	{
+		assert(types[*row] < NumTypes);
+		++typeCounts[types[*row]];
+	}
+
+	ThresholdSplit best{0, 0, 0};
+	for (size_t i = 1; i < numRows; ++i)
+	{
+		++leftCounts[types[first[i - 1]]];
+
+		const auto below = data(first[i - 1], column);
+		const auto above = data(first[i], column);
+		assert(below <= above);
+		if (below == above)
+		{
+			continue;
+		}
+
+		const auto numRight = numRows - i;
+		auto splitTerm = nLog2n[numRows] - nLog2n[i] - nLog2n[numRight];
+		auto typeTerm = 0.0;
+		for (auto type = 0; type < NumTypes; ++type)
+		{
+			const auto count = typeCounts[type];
+			const auto left = leftCounts[type];
+			typeTerm += nLog2n[count] - nLog2n[left] - nLog2n[count - left];
+		}
+
+		const auto splitGain = (splitTerm - typeTerm) / numRows;
+		if (splitGain > best.gain + GainTolerance)
+		{
+			// Halfway between can round up to the value above, which
+			// would put it on the wrong side
+			auto threshold = below + (above - below) / 2;
+			if (!(threshold < above))
+			{
+				threshold = below;
+			}
+			best = ThresholdSplit{splitGain, threshold, i};
+		}
+	}
+
+	std::fill(begin(typeCounts), end(typeCounts), 0);
+	std::fill(begin(leftCounts), end(leftCounts), 0);
+	return best;
+}
+
+/**
+ * The column with the most information gain, or NoAttrIndex if none of
+ * them have any, the same as the bestAttribute function. Columns that
+ * tie go to the first one.
+ */
+size_t ContingencyTable::bestAttribute(const TypeRef& types,
+		const DataRef& data, std::vector<size_t>::const_iterator first,
+		std::vector<size_t>::const_iterator last)
+{
+	double maxGain = -999;
+	size_t ret = 999;
+	for (auto i = 0; i < data.cols(); ++i)
+	{
+		auto colGain = gain(types, data, i, first, last);
+		if (colGain > maxGain + GainTolerance)
+		{
+			ret = i;
+			maxGain = colGain;
+		}
+	}
+
+	return maxGain < GainTolerance ? NoAttrIndex : ret;
+}
+
+/**
+ * Picks the best column the same way bestAttribute does, from gains
+ * that have already been worked out.
+ */
+size_t ContingencyTable::bestOf(const std::vector<double>& gains)
+{
+	double maxGain = -999;
+	size_t ret = 999;
+	for (auto i = 0; i < gains.size(); ++i)
+	{
+		if (gains[i] > maxGain + GainTolerance)
+		{
+			ret = i;
+			maxGain = gains[i];
+		}
+	}
+
+	// If none of the columns improved the entropy, we can't really say
+	// that there is a best column. Instead of defaulting to attribute 0,
+	// we return a special value.
+	if (maxGain < GainTolerance)
+	{
+		return NoAttrIndex;
+	}
+
+	return ret;
+}
@@ -0,0 +1,87 @@
+/*
+ * ContingencyTable.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#ifndef CONTINGENCYTABLE_H_
+#define CONTINGENCYTABLE_H_
+
+#include "Types.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Where to split some rows sorted by a column in two: the first numLeft
+ * rows, which have values up to threshold, and the rest, which are all
+ * bigger.
+ */
+struct ThresholdSplit
+{
+	double gain;
+	Decimal threshold;
+	size_t numLeft;
+};
+
+/**
+ * Works out entropy and information gain for decision trees by counting
+ * how many rows have each pair of (value, class), in one pass over the
+ * rows, and then adding up n log2(n) for each count, which comes from a
+ * table worked out ahead of time:
+ *
+ *   gain = (N log N - sum_v n_v log n_v
+ *           - sum_c (n_c log n_c - sum_v n_vc log n_vc)) / N
+ *
+ * Nothing is allocated or sorted per column, and the counts are cleared
+ * as they're used, so one table can be reused for every column of every
+ * node. Values have to be whole numbers from 0 to 255, like discretized
+ * data, and there can't be more than maxRows rows at a time.
+ *
+ * bestThreshold works on raw values instead. Given rows already sorted
+ * by a column, it tries splitting them between every pair of values in
+ * one pass, moving the counts of each row from the right side of the
+ * split to the left as it goes.
+ *
+ * A table can only be used by one thread at a time. Copies share the
+ * n log2(n) table, so giving each thread a copy is cheap.
+ */
+class ContingencyTable
+{
+public:
+	const size_t MaxRows;
+	const size_t NumTypes;
+
+public:
+	explicit ContingencyTable(size_t maxRows, size_t numTypes);
+	double entropy(const TypeRef& types,
+			std::vector<size_t>::const_iterator first,
+			std::vector<size_t>::const_iterator last);
+	double gain(const TypeRef& types, const DataRef& data, size_t column,
+			std::vector<size_t>::const_iterator first,
+			std::vector<size_t>::const_iterator last);
+	size_t bestAttribute(const TypeRef& types, const DataRef& data,
+			std::vector<size_t>::const_iterator first,
+			std::vector<size_t>::const_iterator last);
+	ThresholdSplit bestThreshold(const TypeRef& types, const DataRef& data,
+			size_t column, std::vector<size_t>::const_iterator first,
+			std::vector<size_t>::const_iterator last);
+	static size_t bestOf(const std::vector<double>& gains);
+
+private:
+	static constexpr size_t NumValues = 256;
+
+	// (*nLog2n)[n] = n * log2(n), and 0 for n = 0
+	std::shared_ptr<const std::vector<double>> nLog2n;
+
+	std::vector<uint32_t> typeCounts;
+	std::vector<uint32_t> leftCounts;
+	std::array<uint32_t, NumValues> valueCounts;
+
+	// How many rows have each type and value, at type * NumValues + value
+	std::vector<uint32_t> counts;
+};
+
+#endif /* CONTINGENCYTABLE_H_ */
@@ -7,96 +7,458 @@
 
 #include "CsvReader.h"
 #include "Dataset.h"
-#include <fstream>
+#include "DatasetStream.h"
+#include "MappedFile.h"
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
-static Dataset readDataset(std::string filename,
+// Readers consume one field from the line [pos, lineEnd) and leave pos
+// pointing just past it. They may be called from several threads at once.
+using NameReader = std::function<std::string(const char*&, const char*)>;
+using TypeReader = std::function<uint8_t(const char*&, const char*)>;
+
+// Longest numeric field we expect to see in a data file
+constexpr size_t MaxFieldLength = 64;
+
+// Smallest piece of a file worth handing to its own thread
+constexpr size_t MinChunkSize = 64 * 1024;
+
+// A row of the dataset, whether it's in a row-major buffer or a DataMatrix
+using RowRef = Eigen::Ref<RowVector, 0, Eigen::InnerStride<>>;
+
+/**
+ * Finds the extent of the field starting at pos, and advances pos past
+ * the comma that ends it (if there is one).
+ */
+static std::pair<const char*, const char*> nextField(const char*& pos,
+		const char* lineEnd)
+{
+	auto fieldStart = pos;
+	auto fieldEnd = static_cast<const char*>(
+			std::memchr(pos, ',', lineEnd - pos));
+	if (fieldEnd == nullptr)
+	{
+		fieldEnd = lineEnd;
+		pos = lineEnd;
+	}
+	else
+	{
+		pos = fieldEnd + 1;
+	}
+	return {fieldStart, fieldEnd};
+}
+
+/**
+ * Copies a field into a null-terminated stack buffer, so it can be handed
+ * to the C conversion functions without allocating a std::string.
+ *
+ * Fields too long for the buffer can't be numbers we'd ever write, so
+ * the file is rejected rather than trusted.
+ */
+static void copyField(std::pair<const char*, const char*> field,
+		char (&buffer)[MaxFieldLength])
+{
+	auto fieldLength = static_cast<size_t>(field.second - field.first);
+	if (fieldLength >= MaxFieldLength)
+	{
+		throw std::runtime_error{"CSV field is too long to be a number"};
+	}
+	std::memcpy(buffer, field.first, fieldLength);
+	buffer[fieldLength] = '\0';
+}
+
+/**
+ * Parses a decimal field. Gives exactly the same result as std::stod.
+ */
+static Decimal readDecimal(const char*& pos, const char* lineEnd)
+{
+	char buffer[MaxFieldLength];
+	copyField(nextField(pos, lineEnd), buffer);
+
+	char* parseEnd = nullptr;
+	auto value = std::strtod(buffer, &parseEnd);
+	if (parseEnd == buffer)
+	{
+		throw std::runtime_error{"CSV field isn't a number"};
+	}
+	return value;
+}
+
+/**
+ * Parses an integer field. Gives exactly the same result as std::stoi.
+ */
+static int readInteger(const char*& pos, const char* lineEnd)
+{
+	char buffer[MaxFieldLength];
+	copyField(nextField(pos, lineEnd), buffer);
+
+	char* parseEnd = nullptr;
+	auto value = std::strtol(buffer, &parseEnd, 10);
+	if (parseEnd == buffer)
+	{
+		throw std::runtime_error{"CSV field isn't an integer"};
+	}
+	return static_cast<int>(value);
+}
+
+/**
+ * Finds the end of the line starting at pos, not counting any DOS line
+ * ending, and advances pos to the start of the following line.
+ */
+static const char* nextLine(const char*& pos, const char* end)
+{
+	const auto lineStart = pos;
+	auto lineEnd = static_cast<const char*>(
+			std::memchr(pos, '\n', end - pos));
+	if (lineEnd == nullptr)
+	{
+		lineEnd = end;
+		pos = end;
+	}
+	else
+	{
+		pos = lineEnd + 1;
+	}
+
+	if (lineEnd > lineStart && *(lineEnd - 1) == '\r')
+	{
+		--lineEnd;
+	}
+	return lineEnd;
+}
+
+/**
+ * Parses one line of the file into a row of data, a name and a type.
+ */
+static void readLine(const char* pos, const char* lineEnd,
+		RowRef row, std::string& name, uint8_t& type,
+		const NameReader& nameReader, const TypeReader& typeReader)
+{
+	// Read the name
+	name = nameReader(pos, lineEnd);
+
+	// Read the data fields
+	for (auto j = 0; j < row.cols(); ++j)
+	{
+		assert(pos < lineEnd);
+		row[j] = readDecimal(pos, lineEnd);
+	}
+
+	// Read the class/type
+	type = typeReader(pos, lineEnd);
+
+	// Must be at end of line now
+	assert(pos == lineEnd);
+}
+
+/**
+ * Reads a whole dataset in a single pass over a memory-mapped file.
+ */
+static Dataset readDatasetSerial(const MappedFile& file,
 		size_t numFields,
 		size_t numClasses,
-		std::function<std::string(std::stringstream&)> nameReader,
-		std::function<uint8_t(std::stringstream&)> typeReader)
+		const NameReader& nameReader,
+		const TypeReader& typeReader)
 {
-	auto line = std::string{};
+	auto pos = file.begin();
+	const auto end = file.end();
+
+	// Guess how many lines there are from the length of the first one,
+	// so we rarely have to grow the buffers while we read.
+	auto firstLineEnd = static_cast<const char*>(
+			std::memchr(pos, '\n', end - pos));
+	auto estimatedLines = firstLineEnd == nullptr
+			? 1 : file.size() / (firstLineEnd - pos + 1) + 1;
 
-	// Figure out the size of the matrix and vectors we'll need
-	auto file = std::ifstream{filename};
-	assert(file.is_open());
-	auto numLines = 0;
-	while(std::getline(file, line))
+	// Values are collected in row-major order, since that's the order
+	// we read them in
+	std::vector<Decimal> values{};
+	values.reserve(estimatedLines * numFields);
+	std::vector<uint8_t> typeValues{};
+	typeValues.reserve(estimatedLines);
+	std::vector<std::string> names{};
+	names.reserve(estimatedLines);
+
+	while (pos < end)
 	{
-		++numLines;
+		auto lineStart = pos;
+		auto lineEnd = nextLine(pos, end);
+
+		values.resize(values.size() + numFields);
+		names.emplace_back();
+		typeValues.push_back(0);
+		readLine(lineStart, lineEnd,
+				Eigen::Map<RowVector>(
+						values.data() + values.size() - numFields, numFields),
+				names.back(), typeValues.back(), nameReader, typeReader);
 	}
 
-	// Return to the start of the file
-	file.clear();
-	file.seekg(0, std::ios::beg);
+	const auto numLines = names.size();
+
+	// Sanity check
+	assert(values.size() == numLines * numFields);
+	assert(typeValues.size() == numLines);
+
+	using RowMajorMatrix = Eigen::Matrix<Decimal, Eigen::Dynamic,
+			Eigen::Dynamic, Eigen::RowMajor>;
+	DataMatrix data = Eigen::Map<const RowMajorMatrix>(
+			values.data(), numLines, numFields);
+	TypeVector types = Eigen::Map<const TypeVector>(
+			typeValues.data(), numLines);
+
+	return Dataset{std::move(names), std::move(types), std::move(data),
+		numClasses};
+}
+
+/**
+ * Reads a dataset by splitting the file into chunks at line boundaries
+ * and parsing every chunk on its own thread.
+ *
+ * Each thread first counts the lines in its chunk, which tells us how big
+ * the dataset is and which rows each chunk owns. Then each thread parses
+ * its chunk straight into its own rows of the final matrix.
+ *
+ * The name and type readers are called from several threads at once,
+ * so they must not have any shared mutable state.
+ */
+static Dataset readDatasetParallel(const MappedFile& file,
+		size_t numFields,
+		size_t numClasses,
+		const NameReader& nameReader,
+		const TypeReader& typeReader,
+		size_t numChunks)
+{
+	const auto begin = file.begin();
+	const auto end = file.end();
+
+	// Pick evenly spaced split points, then push each one forward to the
+	// start of the next line so no line is split between two chunks
+	std::vector<const char*> chunkStarts(numChunks + 1);
+	chunkStarts[0] = begin;
+	chunkStarts[numChunks] = end;
+	for (auto c = 1; c < numChunks; ++c)
+	{
+		auto pos = std::max(begin + file.size() / numChunks * c,
+				chunkStarts[c - 1]);
+		auto newline = static_cast<const char*>(
+				std::memchr(pos, '\n', end - pos));
+		chunkStarts[c] = newline == nullptr ? end : newline + 1;
+	}
+
+	// Count the lines in each chunk
+	std::vector<size_t> chunkLines(numChunks, 0);
+	std::vector<std::thread> workers{};
+	workers.reserve(numChunks);
+	for (auto c = 0; c < numChunks; ++c)
+	{
+		workers.emplace_back([&chunkStarts, &chunkLines, c]() {
+			auto pos = chunkStarts[c];
+			const auto chunkEnd = chunkStarts[c + 1];
+			while (pos < chunkEnd)
+			{
+				auto newline = static_cast<const char*>(
+						std::memchr(pos, '\n', chunkEnd - pos));
+				pos = newline == nullptr ? chunkEnd : newline + 1;
+				++chunkLines[c];
+			}
+		});
+	}
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+	workers.clear();
+
+	// Work out which rows belong to each chunk
+	std::vector<size_t> chunkFirstRows(numChunks + 1, 0);
+	for (auto c = 0; c < numChunks; ++c)
+	{
+		chunkFirstRows[c + 1] = chunkFirstRows[c] + chunkLines[c];
+	}
+	const auto numLines = chunkFirstRows[numChunks];
 
 	// Initialize our vectors to the right size
 	TypeVector types(numLines, 1);
 	DataMatrix data(numLines, numFields);
-	std::vector<std::string> names{};
-	names.reserve(numLines);
+	std::vector<std::string> names(numLines);
 
-	for (auto i = 0; i < numLines; ++i)
+	// Parse every chunk into its own rows. The threads never write to
+	// the same element, so they don't need to synchronize. A bad line
+	// stops its thread, and the error is passed on once they've all
+	// finished.
+	std::vector<std::exception_ptr> errors(numChunks);
+	for (auto c = 0; c < numChunks; ++c)
+	{
+		workers.emplace_back([&, c]() {
+			try
+			{
+				auto pos = chunkStarts[c];
+				const auto chunkEnd = chunkStarts[c + 1];
+				for (auto i = chunkFirstRows[c]; i < chunkFirstRows[c + 1];
+						++i)
+				{
+					auto lineStart = pos;
+					auto lineEnd = nextLine(pos, chunkEnd);
+					readLine(lineStart, lineEnd, data.row(i), names[i],
+							types[i], nameReader, typeReader);
+				}
+				assert(pos == chunkEnd);
+			}
+			catch (...)
+			{
+				errors[c] = std::current_exception();
+			}
+		});
+	}
+	for (auto& worker : workers)
 	{
-		// Read the line
-		std::getline(file, line);
+		worker.join();
+	}
+	for (const auto& error : errors)
+	{
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+	}
 
-		// Local variables
-		auto ssLine = std::stringstream{line};
-		auto field = std::string{};
+	return Dataset{std::move(names), std::move(types), std::move(data),
+		numClasses};
+}
 
-		// Read the name
-		names.push_back(nameReader(ssLine));
+static Dataset readDataset(std::string filename,
+		size_t numFields,
+		size_t numClasses,
+		NameReader nameReader,
+		TypeReader typeReader,
+		unsigned int numThreads)
+{
+	const MappedFile file{filename};
+	file.adviseSequential();
 
-		// Read the data fields
-		for (auto j = 0; j < numFields; ++j)
-		{
-			assert(std::getline(ssLine, field, ','));
-			data(i, j) = std::stod(field);
-		}
+	// Don't bother splitting small files up, since starting the threads
+	// would take longer than reading them.
+	auto numChunks = std::min<size_t>(std::max(numThreads, 1u),
+			file.size() / MinChunkSize);
 
-		// Read the class/type
-		types[i] = typeReader(ssLine);
+	if (numChunks <= 1)
+	{
+		return readDatasetSerial(file, numFields, numClasses,
+				nameReader, typeReader);
+	}
+
+	return readDatasetParallel(file, numFields, numClasses,
+			nameReader, typeReader, numChunks);
+}
+
+/**
+ * Streams a dataset from a CSV file a batch of rows at a time.
+ */
+class CsvDatasetStream : public DatasetStream
+{
+public:
+	explicit CsvDatasetStream(std::string filename,
+			size_t numFields,
+			size_t numClasses,
+			size_t batchSize,
+			NameReader nameReader,
+			TypeReader typeReader);
+	bool next(DatasetBatch& batch) override;
+
+private:
+	MappedFile file;
+	const char* pos;
+	NameReader nameReader;
+	TypeReader typeReader;
+	std::string name; // Names aren't part of a batch, so they go here
+};
+
+CsvDatasetStream::CsvDatasetStream(std::string filename,
+		size_t numFields,
+		size_t numClasses,
+		size_t batchSize,
+		NameReader nameReader,
+		TypeReader typeReader)
+: DatasetStream{numFields, numClasses, batchSize},
+  file{filename},
+  pos{file.begin()},
+  nameReader{std::move(nameReader)},
+  typeReader{std::move(typeReader)},
+  name{}
+{
+	file.adviseSequential();
+}
+
+bool CsvDatasetStream::next(DatasetBatch& batch)
+{
+	if (pos >= file.end())
+	{
+		return false;
+	}
 
-		// Must be at end of string now
-		assert(!std::getline(ssLine, field, ','));
+	batch.types.resize(BatchSize, 1);
+	batch.data.resize(BatchSize, NumFields);
+
+	const auto batchStart = pos;
+	auto numRows = 0;
+	while (numRows < BatchSize && pos < file.end())
+	{
+		auto lineStart = pos;
+		auto lineEnd = nextLine(pos, file.end());
+		readLine(lineStart, lineEnd, batch.data.row(numRows), name,
+				batch.types[numRows], nameReader, typeReader);
+		++numRows;
 	}
 
-	// Sanity check
-	assert(names.size() == data.rows() && data.rows() == types.rows());
+	// The last batch can come up short
+	if (numRows < BatchSize)
+	{
+		batch.types.conservativeResize(numRows, 1);
+		batch.data.conservativeResize(numRows, NumFields);
+	}
 
-	// We must be at the end of the file now
-	assert(!std::getline(file, line));
+	// We won't look at these lines again, so they don't need to stay
+	// in memory
+	file.discard(batchStart, pos);
 
-	return Dataset{names, types, data, numClasses};
+	return true;
 }
 
 // Iris data format has no name field
-auto irisNameReader = [](std::stringstream& ssLine) {
+auto irisNameReader = [](const char*& pos, const char* lineEnd) {
 	return "iris";
 };
 
 // Wine has no name
-auto wineNameReader = [](std::stringstream& ssLine) {
+auto wineNameReader = [](const char*& pos, const char* lineEnd) {
 	return "wine";
 };
 
 // Heart Disease data format has no name
-auto heartDiseaseNameReader = [](std::stringstream& ssLine) {
+auto heartDiseaseNameReader = [](const char*& pos, const char* lineEnd) {
 	return "heartdisease";
 };
 
 // Iris stores type as one of 3 possible strings
-auto irisTypeReader = [](std::stringstream& ssLine) {
-	std::string field;
-	std::getline(ssLine, field, ',');
+auto irisTypeReader = [](const char*& pos, const char* lineEnd) {
+	auto field = nextField(pos, lineEnd);
+	auto fieldLength = static_cast<size_t>(field.second - field.first);
 	uint8_t ret = 0;
 
-	if (field.compare(0, 11, "Iris-setosa") == 0)
+	if (fieldLength >= 11
+			&& std::strncmp(field.first, "Iris-setosa", 11) == 0)
 	{
 		ret = 1;
 	}
-	else if (field.compare(0, 15, "Iris-versicolor") == 0)
+	else if (fieldLength >= 15
+			&& std::strncmp(field.first, "Iris-versicolor", 15) == 0)
 	{
 		ret = 2;
 	}
@@ -108,33 +470,51 @@ auto irisTypeReader = [](std::stringstream& ssLine) {
 };
 
 // Heart Disease data format stores type-1 instead of type
-auto heartDiseaseTypeReader = [](std::stringstream& ssLine) {
-	std::string field;
-	std::getline(ssLine, field, ',');
-	return std::stoi(field) + 1;
+auto heartDiseaseTypeReader = [](const char*& pos, const char* lineEnd) {
+	return static_cast<uint8_t>(readInteger(pos, lineEnd) + 1);
 };
 
 // Wine data format stores type as an integer
-auto wineTypeReader = [](std::stringstream& ssLine) {
-	std::string field;
-	std::getline(ssLine, field, ',');
-	return std::stoi(field);
+auto wineTypeReader = [](const char*& pos, const char* lineEnd) {
+	return static_cast<uint8_t>(readInteger(pos, lineEnd));
 };
 
-Dataset readIrisDataset(std::string filename)
+Dataset readIrisDataset(std::string filename, unsigned int numThreads)
 {
 	return readDataset(filename, IrisFields, IrisClasses,
-			irisNameReader, irisTypeReader);
+			irisNameReader, irisTypeReader, numThreads);
 }
 
-Dataset readWineDataset(std::string filename)
+Dataset readWineDataset(std::string filename, unsigned int numThreads)
 {
 	return readDataset(filename, WineFields, WineClasses,
-			wineNameReader, wineTypeReader);
+			wineNameReader, wineTypeReader, numThreads);
 }
 
-Dataset readHeartDiseaseDataset(std::string filename)
+Dataset readHeartDiseaseDataset(std::string filename, unsigned int numThreads)
 {
 	return readDataset(filename, HeartDiseaseFields, HeartDiseaseClasses,
-			heartDiseaseNameReader, heartDiseaseTypeReader);
+			heartDiseaseNameReader, heartDiseaseTypeReader, numThreads);
+}
+
+std::unique_ptr<DatasetStream> streamIrisDataset(std::string filename,
+		size_t batchSize)
+{
+	return std::make_unique<CsvDatasetStream>(filename, IrisFields,
+			IrisClasses, batchSize, irisNameReader, irisTypeReader);
+}
+
+std::unique_ptr<DatasetStream> streamWineDataset(std::string filename,
+		size_t batchSize)
+{
+	return std::make_unique<CsvDatasetStream>(filename, WineFields,
+			WineClasses, batchSize, wineNameReader, wineTypeReader);
+}
+
+std::unique_ptr<DatasetStream> streamHeartDiseaseDataset(
+		std::string filename, size_t batchSize)
+{
+	return std::make_unique<CsvDatasetStream>(filename, HeartDiseaseFields,
+			HeartDiseaseClasses, batchSize, heartDiseaseNameReader,
+			heartDiseaseTypeReader);
 }
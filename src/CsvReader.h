@@ -9,11 +9,23 @@
 #define CSVREADER_H_
 
 #include "Types.h"
+#include <memory>
 #include <string>
 class Dataset;
+class DatasetStream;
 
-Dataset readIrisDataset(std::string filename);
-Dataset readWineDataset(std::string filename);
-Dataset readHeartDiseaseDataset(std::string filename);
+// Files that can't be read, or with fields that aren't numbers where
+// numbers should be, throw std::runtime_error
+Dataset readIrisDataset(std::string filename, unsigned int numThreads = 1);
+Dataset readWineDataset(std::string filename, unsigned int numThreads = 1);
+Dataset readHeartDiseaseDataset(std::string filename,
+		unsigned int numThreads = 1);
+
+std::unique_ptr<DatasetStream> streamIrisDataset(std::string filename,
+		size_t batchSize);
+std::unique_ptr<DatasetStream> streamWineDataset(std::string filename,
+		size_t batchSize);
+std::unique_ptr<DatasetStream> streamHeartDiseaseDataset(
+		std::string filename, size_t batchSize);
 
 #endif /* CSVREADER_H_ */
@@ -10,21 +10,95 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <new>
 #include <eigen3/Eigen/SVD>
 #include <eigen3/Eigen/Dense>
 #include "Dataset.h"
 #include "Types.h"
-#include "BayesClassifier.h"
-#include "DecisionTree.h"
+#include "DatasetView.h"
+
+namespace
+{
+	// Storage for a dataset that owns its own copy of the data
+	struct OwnedStorage
+	{
+		TypeVector types;
+		DataMatrix data;
+	};
+}
 
 Dataset::Dataset(std::vector<std::string> names, TypeVector types,
 		DataMatrix data, size_t numClasses)
 : NumFields{static_cast<size_t>(data.cols())},
   NumClasses{numClasses},
-  names{names},
-  types{types},
-  data{data}
+  names{std::move(names)},
+  storage{},
+  types{nullptr, 0},
+  data{nullptr, 0, 0},
+  classIndex{}
+{
+	setStorage(std::move(types), std::move(data));
+}
+
+/**
+ * Initialize a dataset that refers to memory owned by someone else,
+ * such as a memory-mapped file. The storage pointer must keep the types
+ * and data alive.
+ *
+ * data is a column-major matrix with size rows and numFields columns.
+ */
+Dataset::Dataset(std::vector<std::string> names,
+		std::shared_ptr<const void> storage,
+		const uint8_t* types, const Decimal* data,
+		size_t size, size_t numFields, size_t numClasses)
+: NumFields{numFields},
+  NumClasses{numClasses},
+  names{std::move(names)},
+  storage{std::move(storage)},
+  types{types, static_cast<Eigen::Index>(size)},
+  data{data, static_cast<Eigen::Index>(size),
+	  static_cast<Eigen::Index>(numFields)},
+  classIndex{}
+{
+	assert(this->names.size() == size);
+	buildClassIndex();
+}
+
+/**
+ * Replaces the data with a copy we own ourselves.
+ */
+void Dataset::setStorage(TypeVector types, DataMatrix data)
+{
+	assert(types.rows() == data.rows());
+	assert(data.cols() == NumFields);
+
+	auto owned = std::make_shared<OwnedStorage>(
+			OwnedStorage{std::move(types), std::move(data)});
+
+	// Eigen maps can't be reassigned, so we have to rebuild them
+	// in place to point at the new memory.
+	new (&this->types) TypeMap{owned->types.data(), owned->types.rows()};
+	new (&this->data) DataMap{owned->data.data(), owned->data.rows(),
+		owned->data.cols()};
+	storage = std::move(owned);
+
+	buildClassIndex();
+}
+
+/**
+ * Sorts the rows into lists by class, so we can find all the points of
+ * one class without searching the whole dataset.
+ */
+void Dataset::buildClassIndex()
 {
+	auto index = std::make_shared<std::vector<std::vector<size_t>>>(
+			NumClasses);
+	for (auto i = 0; i < types.rows(); ++i)
+	{
+		assert(types[i] >= 1 && types[i] <= NumClasses);
+		(*index)[types[i] - 1].push_back(i);
+	}
+	classIndex = std::move(index);
 }
 
 /**
@@ -93,72 +167,39 @@ Partition<Dataset> Dataset::partition(
 
 Dataset Dataset::getSubsetByClass(uint8_t type) const
 {
-	// Check preconditions
-	assert(type >= 1 && type <= NumClasses);
-
-	// Count how large the subset will be
-	auto subsetSize = 0;
-	for (auto i = 0; i < names.size(); ++i)
-	{
-		if (types[i] == type)
-		{
-			++subsetSize;
-		}
-	}
+	const auto& rows = getRowsOfClass(type);
 
 	// End the program if we have a size-0 subclass
-	assert(subsetSize != 0);
+	assert(rows.size() != 0);
 
 	// Initialize our vectors to the right size
 	// Subset types will all be the same
-	auto subsetTypes = TypeVector::Constant(subsetSize, 1, type);
-	auto subsetData = DataMatrix(subsetSize, NumFields);
-	auto subsetNames = std::vector<std::string>(subsetSize);
-
-	// Copy the data into the subset
-	auto numCopied = 0;
-	for (auto i = 0; i < names.size(); ++i)
+	auto subsetTypes = TypeVector::Constant(rows.size(), 1, type);
+	DataMatrix subsetData = data(rows, Eigen::all);
+	std::vector<std::string> subsetNames{};
+	subsetNames.reserve(rows.size());
+	for (auto row : rows)
 	{
-		if (types[i] == type)
-		{
-			subsetNames.push_back(names[i]);
-			subsetData.row(numCopied++) = data.row(i);
-		}
+		subsetNames.push_back(names[row]);
 	}
 
-	// Sanity check
-	assert(numCopied == subsetSize);
-
 	return Dataset{std::move(subsetNames), std::move(subsetTypes),
 		std::move(subsetData), NumClasses};
 }
 
-std::shared_ptr<Classifier> Dataset::classifier(ClassifierType type) const
+/**
+ * Lists the rows that belong to a class, in order.
+ */
+const std::vector<size_t>& Dataset::getRowsOfClass(uint8_t type) const
 {
-	if (type == ClassifierType::DECISION_TREE)
-	{
-		return std::make_shared<DecisionTree>(types, data);
-	}
-
-	std::vector<CovarianceMatrix> cmInverses;
-	std::vector<Decimal> cmDeterminants;
-	std::vector<RowVector> meanVectors;
-	cmInverses.reserve(NumClasses);
-	cmDeterminants.reserve(NumClasses);
-	meanVectors.reserve(NumClasses);
-
-	// Split the training data into classes
-	for (auto i = 1; i <= NumClasses; ++i)
-	{
-		auto trainingClass = getSubsetByClass(i);
-		auto cv = trainingClass.getCovarianceMatrix(type);
-		cmInverses.push_back(getPseudoInverse(cv));
-		cmDeterminants.push_back(getPseudoDeterminant(cv));
-		meanVectors.push_back(trainingClass.getMeans());
-	}
+	assert(type >= 1 && type <= NumClasses);
+	return (*classIndex)[type - 1];
+}
 
-	return std::make_shared<BayesClassifier>(
-			cmInverses, cmDeterminants, meanVectors);
+std::shared_ptr<Classifier> Dataset::classifier(ClassifierType type,
+		unsigned int numThreads) const
+{
+	return DatasetView{*this}.classifier(type, numThreads);
 }
 
 CovarianceMatrix Dataset::getCovarianceMatrix(ClassifierType type) const
@@ -171,10 +212,10 @@ CovarianceMatrix Dataset::getCovarianceMatrix(ClassifierType type) const
 		return CovarianceMatrix::Identity(NumFields, NumFields);
 	}
 
-	Eigen::Matrix<Decimal, Eigen::Dynamic, Eigen::Dynamic> centered
-		= data.rowwise() - getMeans();
-	CovarianceMatrix cov = (centered.transpose() * centered)
-			/ static_cast<Decimal>(data.rows() - 1);
+	AccumulatorMatrix centered = data.cast<Accumulator>();
+	centered.rowwise() -= centered.colwise().mean();
+	CovarianceMatrix cov = ((centered.transpose() * centered)
+			/ static_cast<Accumulator>(data.rows() - 1)).cast<Decimal>();
 
 	// Return the correct type of covariance matrix
 	if (type == ClassifierType::OPTIMAL)
@@ -195,7 +236,7 @@ CovarianceMatrix Dataset::getCovarianceMatrix(ClassifierType type) const
 
 RowVector Dataset::getMeans() const
 {
-	return data.colwise().mean();
+	return data.cast<Accumulator>().colwise().mean().cast<Decimal>();
 }
 
 size_t Dataset::size() const
@@ -203,7 +244,7 @@ size_t Dataset::size() const
 	return names.size();
 }
 
-RowVector Dataset::getPoint(size_t i) const
+DataMap::ConstRowXpr Dataset::getPoint(size_t i) const
 {
 	assert(i < data.rows());
 	return data.row(i);
@@ -215,11 +256,21 @@ uint8_t Dataset::getType(size_t i) const
 	return types[i];
 }
 
-DataMatrix Dataset::getData() const
+const DataMap& Dataset::getData() const
 {
 	return data;
 }
 
+const TypeMap& Dataset::getTypes() const
+{
+	return types;
+}
+
+const std::vector<std::string>& Dataset::getNames() const
+{
+	return names;
+}
+
 void Dataset::shuffle()
 {
 	std::vector<int> permutation;
@@ -235,8 +286,8 @@ void Dataset::shuffle()
 			std::default_random_engine(seed));
 
 	auto shuffledNames = names;
-	auto shuffledTypes = types;
-	auto shuffledData = data;
+	TypeVector shuffledTypes = types;
+	DataMatrix shuffledData = data;
 
 	for (auto i = 0; i < data.rows(); ++i)
 	{
@@ -245,9 +296,8 @@ void Dataset::shuffle()
 		shuffledData.row(i) = data.row(permutation[i]);
 	}
 
-	names = shuffledNames;
-	types = shuffledTypes;
-	data = shuffledData;
+	names = std::move(shuffledNames);
+	setStorage(std::move(shuffledTypes), std::move(shuffledData));
 }
 
 CovarianceMatrix getPseudoInverse(const CovarianceMatrix& matrix)
@@ -25,21 +25,41 @@ public:
 	explicit Dataset(std::vector<std::string> names,
 				TypeVector types, DataMatrix data,
 				size_t numClasses);
+	explicit Dataset(std::vector<std::string> names,
+				std::shared_ptr<const void> storage,
+				const uint8_t* types, const Decimal* data,
+				size_t size, size_t numFields, size_t numClasses);
 	size_t size() const;
 	RowVector getMeans() const;
 	Dataset getSubsetByClass(uint8_t type) const;
+	const std::vector<size_t>& getRowsOfClass(uint8_t type) const;
 	Partition<Dataset> partition(size_t startIndex, size_t endIndex) const;
-	RowVector getPoint(size_t i) const;
+	DataMap::ConstRowXpr getPoint(size_t i) const;
 	uint8_t getType(size_t i) const;
 	CovarianceMatrix getCovarianceMatrix(ClassifierType type) const;
-	std::shared_ptr<Classifier> classifier(ClassifierType type) const;
-	DataMatrix getData() const;
+	std::shared_ptr<Classifier> classifier(ClassifierType type,
+			unsigned int numThreads = 1) const;
+	const DataMap& getData() const;
+	const TypeMap& getTypes() const;
+	const std::vector<std::string>& getNames() const;
 	void shuffle();
 
 private:
+	void setStorage(TypeVector types, DataMatrix data);
+	void buildClassIndex();
+
 	std::vector<std::string> names;
-	TypeVector types;
-	DataMatrix data;
+
+	// Owns the memory that types and data refer to. It's either a copy
+	// we made ourselves, or a memory-mapped file. Copies of a dataset
+	// share it, since it's never modified after it's created.
+	std::shared_ptr<const void> storage;
+	TypeMap types;
+	DataMap data;
+
+	// The rows belonging to each class, in order, indexed by type - 1.
+	// Rebuilt whenever the rows move around.
+	std::shared_ptr<const std::vector<std::vector<size_t>>> classIndex;
 };
 
 CovarianceMatrix getPseudoInverse(const CovarianceMatrix& matrix);
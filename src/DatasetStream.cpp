@@ -0,0 +1,23 @@
+/*
+ * DatasetStream.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#include "DatasetStream.h"
+#include <cassert>
+
+size_t DatasetBatch::size() const
+{
+	return types.rows();
+}
+
+DatasetStream::DatasetStream(size_t numFields, size_t numClasses,
+		size_t batchSize)
+: NumFields{numFields},
+  NumClasses{numClasses},
+  BatchSize{batchSize}
+{
+	assert(batchSize > 0);
+}
@@ -0,0 +1,46 @@
+/*
+ * DatasetStream.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#ifndef DATASETSTREAM_H_
+#define DATASETSTREAM_H_
+
+#include "Types.h"
+#include <cstddef>
+
+/**
+ * A few consecutive rows of a dataset.
+ */
+struct DatasetBatch
+{
+	TypeVector types;
+	DataMatrix data;
+	size_t size() const;
+};
+
+/**
+ * Reads a dataset a batch of rows at a time, so that only one batch has
+ * to be in memory at once no matter how big the dataset is.
+ */
+class DatasetStream
+{
+public:
+	const size_t NumFields;
+	const size_t NumClasses;
+	const size_t BatchSize;
+
+public:
+	explicit DatasetStream(size_t numFields, size_t numClasses,
+			size_t batchSize);
+	virtual ~DatasetStream() = default;
+
+	// Replaces the contents of batch with the next rows of the dataset.
+	// The batch holds BatchSize rows, except at the end of the dataset.
+	// Returns false once there are no rows left.
+	virtual bool next(DatasetBatch& batch) = 0;
+};
+
+#endif /* DATASETSTREAM_H_ */
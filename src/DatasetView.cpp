@@ -0,0 +1,269 @@
+/*
+ * DatasetView.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#include "DatasetView.h"
+#include "ClassStatistics.h"
+#include "Dataset.h"
+#include "DecisionTree.h"
+#include "RandomForest.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <random>
+
+/**
+ * Initialize a view of every row in a dataset.
+ */
+DatasetView::DatasetView(const Dataset& dataset)
+: DatasetView{dataset, {RowSpan{0, dataset.size()}}}
+{
+}
+
+DatasetView::DatasetView(const Dataset& dataset, std::vector<RowSpan> spans)
+: DatasetView{dataset, nullptr, std::move(spans)}
+{
+}
+
+/**
+ * Initialize a view of spans of positions in order, which lists rows
+ * of the dataset.
+ */
+DatasetView::DatasetView(const Dataset& dataset,
+		std::shared_ptr<const std::vector<size_t>> order,
+		std::vector<RowSpan> spans)
+: NumFields{dataset.NumFields},
+  NumClasses{dataset.NumClasses},
+  dataset{&dataset},
+  order{std::move(order)},
+  spans{std::move(spans)},
+  numRows{0}
+{
+	const auto limit = this->order ? this->order->size() : dataset.size();
+	for (const auto& span : this->spans)
+	{
+		assert(span.begin <= span.end && span.end <= limit);
+		numRows += span.end - span.begin;
+	}
+}
+
+size_t DatasetView::size() const
+{
+	return numRows;
+}
+
+/**
+ * Separates the view into training and testing sets, the same way
+ * Dataset::partition does. Testing = elements in [startIndex, endIndex],
+ * and training = everything else.
+ */
+Partition<DatasetView> DatasetView::partition(
+		size_t startIndex, size_t endIndex) const
+{
+	// Check preconditions
+	assert(startIndex <= endIndex);
+	assert(endIndex < size());
+
+	std::vector<RowSpan> trainingSpans{};
+	std::vector<RowSpan> testingSpans{};
+
+	// Cut each of our spans into the parts before, inside and after
+	// the testing range
+	size_t position = 0;
+	for (const auto& span : spans)
+	{
+		const auto spanSize = span.end - span.begin;
+		const auto testStart = std::min(std::max(startIndex, position),
+				position + spanSize) - position;
+		const auto testEnd = std::min(std::max(endIndex + 1, position),
+				position + spanSize) - position;
+
+		if (testStart > 0)
+		{
+			trainingSpans.push_back({span.begin, span.begin + testStart});
+		}
+		if (testEnd > testStart)
+		{
+			testingSpans.push_back({span.begin + testStart,
+				span.begin + testEnd});
+		}
+		if (testEnd < spanSize)
+		{
+			trainingSpans.push_back({span.begin + testEnd, span.end});
+		}
+
+		position += spanSize;
+	}
+
+	auto ret = Partition<DatasetView>{
+		DatasetView{*dataset, order, std::move(trainingSpans)},
+		DatasetView{*dataset, order, std::move(testingSpans)}};
+
+	// Sanity check
+	assert(ret.testing.size() == endIndex - startIndex + 1);
+	assert(ret.training.size() == size() - ret.testing.size());
+
+	return ret;
+}
+
+/**
+ * Works out which row of the dataset the view's i'th row is.
+ */
+size_t DatasetView::getRow(size_t i) const
+{
+	assert(i < numRows);
+	for (const auto& span : spans)
+	{
+		if (i < span.end - span.begin)
+		{
+			return order ? (*order)[span.begin + i] : span.begin + i;
+		}
+		i -= span.end - span.begin;
+	}
+
+	assert(false); // The row has to be in one of the spans
+	return 0;
+}
+
+DataMap::ConstRowXpr DatasetView::getPoint(size_t i) const
+{
+	return dataset->getData().row(getRow(i));
+}
+
+uint8_t DatasetView::getType(size_t i) const
+{
+	return dataset->getType(getRow(i));
+}
+
+/**
+ * Lists the rows of the dataset in the view that belong to a class, in
+ * order. The dataset already knows where each class is, so unless the
+ * view is shuffled this only has to trim its list down to the rows
+ * inside our spans.
+ */
+std::vector<size_t> DatasetView::getRowsOfClass(uint8_t type) const
+{
+	std::vector<size_t> rows{};
+	if (order)
+	{
+		// Sorted, so the statistics add up the same way they would
+		// for the unshuffled rows
+		for (auto row : getRowIndices())
+		{
+			if (dataset->getType(row) == type)
+			{
+				rows.push_back(row);
+			}
+		}
+		std::sort(begin(rows), end(rows));
+		return rows;
+	}
+
+	const auto& classRows = dataset->getRowsOfClass(type);
+
+	for (const auto& span : spans)
+	{
+		auto first = std::lower_bound(cbegin(classRows), cend(classRows),
+				span.begin);
+		auto last = std::lower_bound(first, cend(classRows), span.end);
+		rows.insert(end(rows), first, last);
+	}
+	return rows;
+}
+
+/**
+ * Trains a classifier on the rows in the view. Trees and forests are
+ * trained with numThreads threads; Bayes classifiers don't need any.
+ */
+std::shared_ptr<Classifier> DatasetView::classifier(ClassifierType type,
+		unsigned int numThreads) const
+{
+	if (type == ClassifierType::DECISION_TREE)
+	{
+		return std::make_shared<DecisionTree>(*this, SplitMethod::BY_VALUE,
+				numThreads);
+	}
+	else if (type == ClassifierType::THRESHOLD_TREE)
+	{
+		return std::make_shared<DecisionTree>(*this,
+				SplitMethod::BY_THRESHOLD, numThreads);
+	}
+	else if (type == ClassifierType::RANDOM_FOREST)
+	{
+		return std::make_shared<RandomForest>(*this, DefaultForestSize,
+				numThreads);
+	}
+
+	ClassStatistics stats{NumFields, NumClasses};
+	for (auto i = 1; i <= NumClasses; ++i)
+	{
+		stats.add(dataset->getData(), i, getRowsOfClass(i));
+	}
+	return stats.classifier(type);
+}
+
+const Dataset& DatasetView::getDataset() const
+{
+	return *dataset;
+}
+
+const std::vector<RowSpan>& DatasetView::getSpans() const
+{
+	return spans;
+}
+
+/**
+ * Lists the rows of the dataset that are in the view, in the view's
+ * order.
+ */
+std::vector<size_t> DatasetView::getRowIndices() const
+{
+	std::vector<size_t> rows{};
+	rows.reserve(numRows);
+	for (const auto& span : spans)
+	{
+		for (auto position = span.begin; position < span.end; ++position)
+		{
+			rows.push_back(order ? (*order)[position] : position);
+		}
+	}
+	return rows;
+}
+
+/**
+ * Copies the points in the view into one block, in the view's order,
+ * so they can all be classified with one classifyBatch.
+ */
+DataMatrix DatasetView::getPoints() const
+{
+	const auto& data = dataset->getData();
+	DataMatrix points(numRows, NumFields);
+	auto i = 0;
+	for (auto row : getRowIndices())
+	{
+		points.row(i++) = data.row(row);
+	}
+	return points;
+}
+
+/**
+ * Gives a view of the same rows in a random order. The order is a list
+ * of rows shared by the view and every view partitioned from it, so
+ * none of the data is copied.
+ */
+DatasetView DatasetView::shuffled() const
+{
+	auto rows = getRowIndices();
+	unsigned seed =
+			std::chrono::system_clock::now().time_since_epoch().count();
+	std::shuffle(rows.begin(), rows.end(),
+			std::default_random_engine(seed));
+
+	const auto size = rows.size();
+	return DatasetView{*dataset,
+		std::make_shared<const std::vector<size_t>>(std::move(rows)),
+		{RowSpan{0, size}}};
+}
@@ -0,0 +1,77 @@
+/*
+ * DatasetView.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#ifndef DATASETVIEW_H_
+#define DATASETVIEW_H_
+
+#include "Classifier.h"
+#include "Partition.h"
+#include "Types.h"
+#include <memory>
+#include <vector>
+class Dataset;
+
+/**
+ * A range of rows in a dataset, from begin up to but not including end.
+ * In a shuffled view, a range of positions in the view's order instead.
+ */
+struct RowSpan
+{
+	size_t begin;
+	size_t end;
+};
+
+/**
+ * Some of the rows of a dataset, without copying them. Partitioning a
+ * view just makes more views, so training and testing on folds of a
+ * dataset never copies any of the data.
+ *
+ * A view refers to the dataset it came from, so the dataset has to
+ * outlive it.
+ *
+ * A shuffled view also has its own order of the rows, shared with every
+ * view partitioned from it, and its spans are ranges of positions in
+ * that order instead of ranges of the dataset's rows. Folds of a
+ * shuffled view are still just a span or two, so finding a row stays
+ * cheap.
+ */
+class DatasetView
+{
+public:
+	const size_t NumFields;
+	const size_t NumClasses;
+
+public:
+	explicit DatasetView(const Dataset& dataset);
+	explicit DatasetView(const Dataset& dataset, std::vector<RowSpan> spans);
+	size_t size() const;
+	Partition<DatasetView> partition(size_t startIndex,
+			size_t endIndex) const;
+	DataMap::ConstRowXpr getPoint(size_t i) const;
+	uint8_t getType(size_t i) const;
+	std::vector<size_t> getRowsOfClass(uint8_t type) const;
+	std::shared_ptr<Classifier> classifier(ClassifierType type,
+			unsigned int numThreads = 1) const;
+	const Dataset& getDataset() const;
+	const std::vector<RowSpan>& getSpans() const;
+	std::vector<size_t> getRowIndices() const;
+	DataMatrix getPoints() const;
+	DatasetView shuffled() const;
+
+private:
+	explicit DatasetView(const Dataset& dataset,
+			std::shared_ptr<const std::vector<size_t>> order,
+			std::vector<RowSpan> spans);
+	size_t getRow(size_t i) const;
+
+	const Dataset* dataset;
+	std::shared_ptr<const std::vector<size_t>> order; // Null if unshuffled
+	std::vector<RowSpan> spans;
+	size_t numRows;
+};
+
+#endif /* DATASETVIEW_H_ */
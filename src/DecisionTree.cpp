@@ -6,8 +6,15 @@
  */
 
 #include "DecisionTree.h"
+#include "ContingencyTable.h"
+#include "Dataset.h"
+#include "DatasetView.h"
 #include "Types.h"
+#include "WorkStealingPool.h"
+#include <array>
+#include <atomic>
 #include <cmath>
+#include <numeric>
 #include <vector>
 #include <algorithm>
 #include <cassert>
@@ -15,47 +22,411 @@
 #include <sstream>
 #include <iostream>
 #include <iomanip>
+#include <limits>
+#include <type_traits>
 
-static std::vector<uint8_t> colToStdVector(const ColVector& col);
-static std::vector<uint8_t> rowToStdVector(const RowVector& row);
-static std::vector<uint8_t> getUniqueValues(std::vector<uint8_t> vec);
+static std::vector<size_t> allRows(size_t numRows);
+static ContingencyTable tableFor(const TypeRef& types, size_t numRows);
+static std::vector<uint8_t> getUniqueValues(const DataRef& data,
+		size_t column, std::vector<size_t>::const_iterator first,
+		std::vector<size_t>::const_iterator last);
+static uint8_t mostCommonType(const TypeRef& types,
+		std::vector<size_t>::const_iterator first,
+		std::vector<size_t>::const_iterator last);
+static uint64_t nextRandom(uint64_t& state);
+static std::string decimalTypeName();
+static std::string decimalLiteral(Decimal value);
 
-DecisionTree::DecisionTree(const TypeVector& types, const DataMatrix& data)
-: nodeCount{0}
+// Children with fewer rows than this are built by whoever made them,
+// since handing them to another thread would take longer
+constexpr size_t MinTaskRows = 256;
+
+// Nodes with at least this many rows work out the gains of their
+// columns in parallel
+constexpr size_t ParallelGainMinRows = 16384;
+
+/**
+ * Everything the nodes need while the tree is being built.
+ */
+struct DecisionTree::Builder
+{
+	size_t bestAttribute(size_t worker,
+			std::vector<size_t>::const_iterator first,
+			std::vector<size_t>::const_iterator last);
+	void sortColumns(size_t worker, const std::vector<size_t>& rows);
+	size_t bestThreshold(size_t worker, size_t first, size_t last,
+			uint64_t seed, ThresholdSplit& split);
+	size_t bestThresholdOf(size_t worker, size_t first, size_t last,
+			const std::vector<uint8_t>& columns, ThresholdSplit& split);
+	void splitColumns(size_t worker, size_t column, size_t first,
+			size_t middle, size_t last);
+	template <typename Function>
+	void forEachColumn(size_t worker, size_t numRows, Function function);
+
+	const TypeRef& types;
+	const DataRef& data;
+
+	// Scratch space for working out gains, one for each worker
+	std::vector<ContingencyTable> tables;
+
+	// Only set when building on more than one thread
+	WorkStealingPool* pool;
+
+	// Only used splitting on thresholds: the rows sorted by each column,
+	// which side of its node's split each row goes to, and somewhere
+	// for each worker to put rows while splitting
+	std::vector<std::vector<size_t>> sorted;
+	std::vector<uint8_t> goesRight;
+	std::vector<std::vector<size_t>> scratch;
+
+	// How many columns each node gets to pick a threshold from
+	size_t attributesPerNode;
+};
+
+/**
+ * Calls function(worker, column) for every column, in parallel if
+ * there are enough rows to be worth it.
+ */
+template <typename Function>
+void DecisionTree::Builder::forEachColumn(size_t worker, size_t numRows,
+		Function function)
+{
+	if (pool == nullptr || numRows < ParallelGainMinRows || data.cols() < 2)
+	{
+		for (size_t j = 0; j < data.cols(); ++j)
+		{
+			function(worker, j);
+		}
+		return;
+	}
+
+	std::atomic<size_t> pending{static_cast<size_t>(data.cols())};
+	for (size_t j = 0; j < data.cols(); ++j)
+	{
+		pool->spawn(worker, [&function, &pending, j](size_t columnWorker)
+		{
+			function(columnWorker, j);
+			--pending;
+		});
+	}
+	pool->waitFor(worker, pending);
+}
+
+/**
+ * Finds the best column to split some rows on, working out the gains
+ * of the columns in parallel if there are enough rows to be worth it.
+ */
+size_t DecisionTree::Builder::bestAttribute(size_t worker,
+		std::vector<size_t>::const_iterator first,
+		std::vector<size_t>::const_iterator last)
 {
-	root = std::make_unique<Node>(types, data, *this);
+	if (pool == nullptr || last - first < ParallelGainMinRows
+			|| data.cols() < 2)
+	{
+		return tables[worker].bestAttribute(types, data, first, last);
+	}
+
+	std::vector<double> gains(data.cols());
+	forEachColumn(worker, last - first,
+			[this, &gains, first, last](size_t columnWorker, size_t j)
+	{
+		gains[j] = tables[columnWorker].gain(types, data, j, first, last);
+	});
+
+	return ContingencyTable::bestOf(gains);
 }
 
 /**
- * Initialize a root node on the decision tree.
+ * Sorts the rows by each column, ready for splitting them on
+ * thresholds. Rows with the same value stay in the order they were
+ * given in.
  */
-DecisionTree::Node::Node(const TypeVector& types, const DataMatrix& data,
-		DecisionTree& dt)
-: Node{NoParentAttrValue, nullptr, types, data, 0, dt}
+void DecisionTree::Builder::sortColumns(size_t worker,
+		const std::vector<size_t>& rows)
 {
+	sorted.assign(data.cols(), rows);
+	forEachColumn(worker, rows.size(), [this](size_t, size_t j)
+	{
+		std::stable_sort(begin(sorted[j]), end(sorted[j]),
+				[this, j](size_t a, size_t b)
+				{
+					return data(a, j) < data(b, j);
+				});
+	});
 }
 
 /**
- * Initialize a child node on the decision tree.
+ * Finds the column and threshold that best split the rows of a node,
+ * which are at [first, last) in the sorted lists. Gives NoAttrIndex if
+ * no split gains anything.
  *
- * Each node on the tree looks at an attribute, the value of which can
- * fall into several different classes.
+ * If nodes only get some of the columns, they're picked at random using
+ * the node's seed. When none of those help, the node tries the rest
+ * before giving up, so trees don't stop early just because they were
+ * unlucky.
+ */
+size_t DecisionTree::Builder::bestThreshold(size_t worker, size_t first,
+		size_t last, uint64_t seed, ThresholdSplit& split)
+{
+	const auto numColumns = static_cast<size_t>(data.cols());
+	if (attributesPerNode >= numColumns)
+	{
+		const std::vector<uint8_t> columns(numColumns, true);
+		return bestThresholdOf(worker, first, last, columns, split);
+	}
+
+	// Shuffle just the first attributesPerNode columns into place
+	std::vector<size_t> order(numColumns);
+	std::iota(begin(order), end(order), 0);
+	std::vector<uint8_t> columns(numColumns, false);
+	for (size_t i = 0; i < attributesPerNode; ++i)
+	{
+		std::swap(order[i], order[i + nextRandom(seed) % (numColumns - i)]);
+		columns[order[i]] = true;
+	}
+
+	auto column = bestThresholdOf(worker, first, last, columns, split);
+	if (column == NoAttrIndex)
+	{
+		for (auto& tried : columns)
+		{
+			tried = !tried;
+		}
+		column = bestThresholdOf(worker, first, last, columns, split);
+	}
+	return column;
+}
+
+/**
+ * Finds the best split out of the columns that are set in columns.
+ */
+size_t DecisionTree::Builder::bestThresholdOf(size_t worker, size_t first,
+		size_t last, const std::vector<uint8_t>& columns,
+		ThresholdSplit& split)
+{
+	std::vector<ThresholdSplit> splits(data.cols(), ThresholdSplit{0, 0, 0});
+	forEachColumn(worker, last - first,
+			[this, &splits, &columns, first, last](size_t columnWorker,
+					size_t j)
+	{
+		if (columns[j])
+		{
+			splits[j] = tables[columnWorker].bestThreshold(types, data, j,
+					cbegin(sorted[j]) + first, cbegin(sorted[j]) + last);
+		}
+	});
+
+	std::vector<double> gains(data.cols());
+	for (auto j = 0; j < data.cols(); ++j)
+	{
+		gains[j] = splits[j].gain;
+	}
+
+	const auto column = ContingencyTable::bestOf(gains);
+	if (column != NoAttrIndex)
+	{
+		split = splits[column];
+	}
+	return column;
+}
+
+/**
+ * Splits a node's stretch of every sorted list in two, with the rows at
+ * [first, middle) in the list for column going to the left. Each half
+ * stays sorted, so the children don't need to sort anything.
+ */
+void DecisionTree::Builder::splitColumns(size_t worker, size_t column,
+		size_t first, size_t middle, size_t last)
+{
+	for (auto i = first; i < last; ++i)
+	{
+		goesRight[sorted[column][i]] = i >= middle;
+	}
+
+	forEachColumn(worker, last - first,
+			[this, column, first, last](size_t columnWorker, size_t j)
+	{
+		if (j == column)
+		{
+			return;
+		}
+
+		// Rows going left are packed down in place, and the ones going
+		// right are put to one side and copied in after them
+		auto& rows = sorted[j];
+		auto& right = scratch[columnWorker];
+		auto left = first;
+		size_t numRight = 0;
+		for (auto i = first; i < last; ++i)
+		{
+			if (goesRight[rows[i]])
+			{
+				right[numRight++] = rows[i];
+			}
+			else
+			{
+				rows[left++] = rows[i];
+			}
+		}
+		std::copy(cbegin(right), cbegin(right) + numRight,
+				begin(rows) + left);
+	});
+}
+
+DecisionTree::DecisionTree(const TypeRef& types, const DataRef& data,
+		SplitMethod method, unsigned int numThreads)
+: method{method},
+  nodeCount{0},
+  flat{},
+  info{}
+{
+	auto rows = allRows(types.rows());
+	build(types, data, rows, numThreads, data.cols(), 0, {});
+}
+
+/**
+ * Builds a tree from the rows in a view, without copying them.
+ */
+DecisionTree::DecisionTree(const DatasetView& view, SplitMethod method,
+		unsigned int numThreads)
+: method{method},
+  nodeCount{0},
+  flat{},
+  info{}
+{
+	const auto& dataset = view.getDataset();
+	auto rows = view.getRowIndices();
+	build(dataset.getTypes(), dataset.getData(), rows, numThreads,
+			dataset.NumFields, 0, {});
+}
+
+/**
+ * Builds one tree of a random forest: split on thresholds, picking from
+ * attributesPerNode random columns at each node. The same seed always
+ * gives the same tree.
+ *
+ * sortedRows are the rows to train on already sorted by each column,
+ * so a forest can sort its training set once and hand every tree its
+ * sample in order, rather than each tree sorting its own. Rows can be
+ * in the sample more than once.
+ */
+DecisionTree::DecisionTree(const TypeRef& types, const DataRef& data,
+		std::vector<std::vector<size_t>> sortedRows,
+		size_t attributesPerNode, uint64_t seed)
+: method{SplitMethod::BY_THRESHOLD},
+  nodeCount{0},
+  flat{},
+  info{}
+{
+	assert(attributesPerNode > 0);
+	assert(sortedRows.size() == data.cols());
+	auto rows = sortedRows[0];
+	build(types, data, rows, 1, attributesPerNode, seed,
+			std::move(sortedRows));
+}
+
+/**
+ * Trains the tree on some rows, then packs it into the flat arrays we
+ * classify with. The nodes themselves aren't needed after that.
+ *
+ * The tree is built by shuffling the rows around in place, so they
+ * end up in a different order.
+ */
+void DecisionTree::build(const TypeRef& types, const DataRef& data,
+		std::vector<size_t>& rows, unsigned int numThreads,
+		size_t attributesPerNode, uint64_t seed,
+		std::vector<std::vector<size_t>> sortedRows)
+{
+	Node root{NoParentAttrValue, nullptr, 0};
+	root.seed = seed;
+	const auto numWorkers = std::max(numThreads, 1u);
+	Builder builder{types, data,
+		std::vector<ContingencyTable>(numWorkers,
+				tableFor(types, rows.size())),
+		nullptr, std::move(sortedRows), {}, {}, attributesPerNode};
+	if (method == SplitMethod::BY_THRESHOLD)
+	{
+		builder.goesRight.resize(data.rows());
+		builder.scratch.assign(numWorkers, std::vector<size_t>(rows.size()));
+	}
+
+	auto buildRoot = [&](size_t worker)
+	{
+		if (method == SplitMethod::BY_THRESHOLD)
+		{
+			if (builder.sorted.empty())
+			{
+				builder.sortColumns(worker, rows);
+			}
+			root.split(builder, worker, 0, rows.size());
+		}
+		else
+		{
+			root.build(builder, worker, begin(rows), end(rows));
+		}
+	};
+
+	if (numWorkers == 1)
+	{
+		buildRoot(0);
+	}
+	else
+	{
+		WorkStealingPool pool{numWorkers};
+		builder.pool = &pool;
+		pool.run(buildRoot);
+	}
+
+	nodeCount = root.number(0);
+	flat.nodes.reserve(nodeCount);
+	info.reserve(nodeCount);
+	root.flatten(*this);
+}
+
+/**
+ * Initialize a node on the decision tree. It doesn't know anything
+ * until it's built.
  *
  * parentAttrValue: Value matched for the parent's distinguishing attribute
  */
 DecisionTree::Node::Node(size_t parentAttrValue, const Node* parent,
-		const TypeVector& types, const DataMatrix& data,
-		 size_t attributesChecked, DecisionTree& dt)
+		size_t attributesChecked)
 : parentAttrValue{parentAttrValue},
   parent{parent},
   attributesChecked{attributesChecked},
+  nodeNumber{0},
+  seed{0},
   children{},
   attributeIndex{NoAttrIndex},
+  threshold{0},
   type{NoType},
-  nodeNumber{dt.nodeCount++},
-  dataSize{static_cast<size_t>(data.rows())},
-  dataEntropy{entropy(types)}
+  dataSize{0},
+  dataEntropy{0}
 {
+}
+
+/**
+ * Trains a node, and everything under it.
+ *
+ * Each node on the tree looks at an attribute, the value of which can
+ * fall into several different classes.
+ *
+ * first, last: Which rows of types and data this node is trained on.
+ * The node sorts them out among its children by partitioning them in
+ * place, quicksort-style, so however deep the tree gets, it never needs
+ * more than the one list of rows. Children only ever touch their own
+ * part of it, so they can be built at the same time.
+ */
+void DecisionTree::Node::build(Builder& builder, size_t worker,
+		std::vector<size_t>::iterator first,
+		std::vector<size_t>::iterator last)
+{
+	const auto& types = builder.types;
+	const auto& data = builder.data;
+
+	dataSize = last - first;
+	dataEntropy = builder.tables[worker].entropy(types, first, last);
+
 	// Turn this node into a correct leaf node, or make its children
 	if (dataEntropy == 0)
 	{
@@ -63,14 +434,14 @@ DecisionTree::Node::Node(size_t parentAttrValue, const Node* parent,
 
 		// In an ideal leaf node every data point is of the same type,
 		// which is the type returned by the classifier.
-		type = types(0, 0);
+		type = types[*first];
 	}
 	else
 	{
 		// Find the most informative attribute to base the children on.
 		// Note that this returns NoAttrIndex if none of the attributes
 		// will help improve the match.
-		attributeIndex = bestAttribute(types, data);
+		attributeIndex = builder.bestAttribute(worker, first, last);
 
 		// If the data still fall into more than one class, but we've already
 		// checked all the attributes (or if checking the remaining attributes
@@ -82,21 +453,7 @@ DecisionTree::Node::Node(size_t parentAttrValue, const Node* parent,
 			// and we still can't build a perfect classifier
 
 			// Return the most likely type
-			auto uniqueTypes
-				= getUniqueValues(colToStdVector(types.cast<Decimal>()));
-			std::vector<size_t> counts(uniqueTypes.size(), 0);
-			for (auto i = 0; i < uniqueTypes.size(); ++i)
-			{
-				for (auto j = 0; j < types.size(); ++j)
-				{
-					if (types[j] == uniqueTypes[i])
-					{
-						++counts[i];
-					}
-				}
-			}
-			type = uniqueTypes[*std::max_element(cbegin(counts),
-					cend(counts))];
+			type = mostCommonType(types, first, last);
 		}
 		else
 		{
@@ -104,127 +461,202 @@ DecisionTree::Node::Node(size_t parentAttrValue, const Node* parent,
 			// so generate child nodes.
 
 			// We'll need a new child for every unique value in the column
-			auto uniqueValues = getUniqueValues(colToStdVector(
-					data.col(attributeIndex)));
+			auto uniqueValues = getUniqueValues(data, attributeIndex,
+					first, last);
 
 			// Make the children
 			for (auto val : uniqueValues)
 			{
-				// Calculate how big the data subset will be
-				auto subsetSize = 0;
-				for (auto i = 0; i < data.rows(); ++i)
-				{
-					if (data(i, attributeIndex) == val)
-					{
-						++subsetSize;
-					}
-				}
+				// Move the rows that go to this child to the front of
+				// the ones we haven't handed out yet
+				auto childLast = std::partition(first, last,
+						[&](size_t row)
+						{
+							return data(row, attributeIndex) == val;
+						});
 
-				assert(subsetSize > 0);
+				assert(childLast != first);
 
-				// Populate the subset with the right rows from the original
-				DataMatrix subsetData{subsetSize, data.cols()};
-				TypeVector subsetTypes{subsetSize, 1};
-				auto insertIndex = 0;
-				for (auto i = 0; i < data.rows(); ++i)
+				children.emplace_front(val, this, attributesChecked + 1);
+				auto& child = children.front();
+				if (builder.pool != nullptr && childLast - first >= MinTaskRows)
 				{
-					if (data(i, attributeIndex) == val)
+					builder.pool->spawn(worker,
+							[&builder, &child, first, childLast](
+									size_t childWorker)
 					{
-						subsetTypes.row(insertIndex) = types.row(i);
-						subsetData.row(insertIndex) = data.row(i);
-						++insertIndex;
-					}
+						child.build(builder, childWorker, first, childLast);
+					});
 				}
-
-				children.emplace_front(val, this, subsetTypes, subsetData,
-						attributesChecked + 1, dt);
+				else
+				{
+					child.build(builder, worker, first, childLast);
+				}
+				first = childLast;
 			}
 		}
 	}
 }
 
 /**
- * Tells you what class a data point belongs to.
+ * Trains a node, and everything under it, by splitting its rows in two
+ * on whichever threshold of whichever attribute tells us the most.
+ *
+ * first, last: Where the node's rows are in every one of the builder's
+ * sorted lists. Unlike splitting by value, an attribute can be split on
+ * again further down, so the tree keeps going until its leaves are
+ * pure or no threshold helps.
  */
-uint8_t DecisionTree::classify(const RowVector& dataPoint) const
+void DecisionTree::Node::split(Builder& builder, size_t worker,
+		size_t first, size_t last)
 {
-	const auto *node = root.get();
+	const auto& types = builder.types;
+	const auto rowsFirst = cbegin(builder.sorted[0]) + first;
+	const auto rowsLast = cbegin(builder.sorted[0]) + last;
 
-	while (node != nullptr)
+	dataSize = last - first;
+	dataEntropy = builder.tables[worker].entropy(types, rowsFirst, rowsLast);
+	if (dataEntropy == 0)
 	{
-		bool foundChild = false;
+		type = types[*rowsFirst];
+		return;
+	}
 
-		// Stop if the current node has no children
-		if (node->children.size() == 0)
-		{
-			assert(node->type != NoType);
-			return node->type;
-		}
+	ThresholdSplit best{};
+	attributeIndex = builder.bestThreshold(worker, first, last, seed, best);
+	if (attributeIndex == NoAttrIndex)
+	{
+		type = mostCommonType(types, rowsFirst, rowsLast);
+		return;
+	}
 
-		// Advance to the correct child, based on the data point we have
-		for (const auto& child : node->children)
-		{
-			assert(child.parentAttrValue != NoParentAttrValue);
-			assert(node->attributeIndex != NoAttrIndex);
+	threshold = best.threshold;
+	const auto middle = first + best.numLeft;
+	builder.splitColumns(worker, attributeIndex, first, middle, last);
+
+	// The left child gets value 0 and the right 1, so they're numbered
+	// and flattened the same way value children are
+	const std::array<size_t, 2> bounds[] = {{first, middle}, {middle, last}};
+	for (size_t side = 0; side < 2; ++side)
+	{
+		const auto childFirst = bounds[side][0];
+		const auto childLast = bounds[side][1];
 
-			if (child.parentAttrValue == dataPoint[node->attributeIndex])
+		children.emplace_front(side, this, attributesChecked + 1);
+		auto& child = children.front();
+		auto childSeed = seed + side;
+		child.seed = nextRandom(childSeed);
+		if (builder.pool != nullptr && childLast - childFirst >= MinTaskRows)
+		{
+			builder.pool->spawn(worker,
+					[&builder, &child, childFirst, childLast](
+							size_t childWorker)
 			{
-				node = &child;
-				foundChild = true;
-				break;
-			}
+				child.split(builder, childWorker, childFirst, childLast);
+			});
 		}
-
-		// If we reach here and there was no correct child, that means
-		// we are unable to classify the given data point because we
-		// had nothing like it in the training set.
-		//
-		// This actually happens quite a bit if the training set is too
-		// small or some dimensions have rare values.
-		if (!foundChild)
+		else
 		{
-			return NoType;
+			child.split(builder, worker, childFirst, childLast);
 		}
 	}
+}
 
-	// Failed to find a type for unknown reasons. Should never happen.
-	assert(false);
-	return NoType; // Just prevents a compiler warning
+/**
+ * Numbers the node and everything under it for the graph output, in
+ * the order they'd have been made building the tree on one thread,
+ * starting from next. Gives the next number after them.
+ */
+size_t DecisionTree::Node::number(size_t next)
+{
+	nodeNumber = next++;
+
+	// Children were made in order of value, which is the reverse of the
+	// order they're listed in
+	for (auto child = children.rbegin(); child != children.rend(); ++child)
+	{
+		next = child->number(next);
+	}
+	return next;
+}
+
+/**
+ * Tells you what class a data point belongs to.
+ *
+ * If the tree reaches a value it has no child for, that means we are
+ * unable to classify the given data point because we had nothing like
+ * it in the training set, and we give NoType. This actually happens
+ * quite a bit if the training set is too small or some dimensions have
+ * rare values.
+ */
+uint8_t DecisionTree::classify(const PointRef& dataPoint) const
+{
+	return classifyFlat(flat.nodes.data(), flat.childTable.data(),
+			flat.thresholds.data(), dataPoint);
 }
 
-std::ostream& DecisionTree::Node::print(std::ostream& out) const
+std::ostream& DecisionTree::printNode(std::ostream& out,
+		uint32_t index) const
 {
+	const auto& node = flat.nodes[index];
+	const auto& nodeInfo = info[index];
+
 	// Limit output in number of decimal places
 	auto oldflags = out.flags();
 	auto oldprecision = out.precision();
 	out << std::fixed << std::setprecision(3);
 
-	if (children.size() == 0)
+	if (node.numValues == 0)
 	{
-		out << nodeNumber << " [";
-		if (dataEntropy > 0)
+		out << nodeInfo.nodeNumber << " [";
+		if (nodeInfo.dataEntropy > 0)
 		{
 			out << "color=\"red\",";
 		}
-		out << "label=\"Type " << static_cast<int>(type)
-			<< " |{ " << dataSize << " | "
-			<< dataEntropy << "}" << "\"]" << std::endl;
+		out << "label=\"Type " << static_cast<int>(node.type)
+			<< " |{ " << nodeInfo.dataSize << " | "
+			<< nodeInfo.dataEntropy << "}" << "\"]" << std::endl;
 	}
 	else
 	{
-		out << nodeNumber << " [label=\"Attr "
-					<< attributeIndex
-					<< " |{ " << dataSize << " | "
-					<< dataEntropy << "}" << "\"]"
+		out << nodeInfo.nodeNumber << " [label=\"Attr "
+					<< node.attribute
+					<< " |{ " << nodeInfo.dataSize << " | "
+					<< nodeInfo.dataEntropy << "}" << "\"]"
 					<< std::endl;
 
-		for (const auto& child : children)
+		if (node.numValues == ThresholdNode)
+		{
+			const auto threshold = flat.thresholds[index];
+			for (auto side = 0; side < 2; ++side)
+			{
+				const auto child = flat.childTable[node.children + side];
+				out << nodeInfo.nodeNumber
+				    << " -> " << info[child].nodeNumber
+				    << " [label=\" " << (side == 0 ? "<=" : ">")
+				    << threshold << "\"]" << std::endl;
+				printNode(out, child);
+			}
+		}
+		else
 		{
-			out << nodeNumber
-			    << " -> " << child.nodeNumber
-			    << " [label=\" =" << static_cast<int>(child.parentAttrValue)
-				<< "\"]" << std::endl;
-			child.print(out);
+			// Children go from the largest value to the smallest, the
+			// order they were made in
+			for (auto value = static_cast<int>(node.numValues) - 1;
+					value >= 0; --value)
+			{
+				const auto child = flat.childTable[node.children + value];
+				if (child == NoChild)
+				{
+					continue;
+				}
+
+				out << nodeInfo.nodeNumber
+				    << " -> " << info[child].nodeNumber
+				    << " [label=\" =" << value
+					<< "\"]" << std::endl;
+				printNode(out, child);
+			}
 		}
 	}
 
@@ -239,52 +671,202 @@ std::ostream& DecisionTree::print(std::ostream& out) const
 {
 	out << "digraph DT {" << std::endl
 	    << "    node [shape=record, fontname=\"Arial\"];" << std::endl;
-	root->print(out);
+	printNode(out, 0);
 	out << "}" << std::endl;
 	return out;
 }
 
-std::ostream& operator<<(std::ostream& out, const DecisionTree& dt)
+/**
+ * Writes the tree out as the source of a C++ function that classifies a
+ * point the same way classify does, so a trained tree can be compiled
+ * straight into a program. Nodes that split by value become switch
+ * statements and ones that split on a threshold become ifs, so it's
+ * just a few branches per level, with nothing to load or look up.
+ *
+ * The function takes the point as an array of the same Decimal type
+ * the tree was trained with, so thresholds compare exactly the way they
+ * do here. The source only needs <cstdint>.
+ */
+std::ostream& DecisionTree::printSource(std::ostream& out,
+		const std::string& functionName) const
 {
-	return dt.print(out);
+	out << "// Generated from a trained decision tree. Gives the type of a"
+		<< std::endl
+		<< "// point, or " << static_cast<int>(NoType)
+		<< " if the tree has never seen anything like it." << std::endl
+		<< "#include <cstdint>" << std::endl
+		<< std::endl
+		<< "inline std::uint8_t " << functionName << "(const "
+		<< decimalTypeName() << "* point)" << std::endl
+		<< "{" << std::endl;
+	printSourceNode(out, 0, 1);
+	out << "}" << std::endl;
+	return out;
+}
+
+std::ostream& DecisionTree::printSourceNode(std::ostream& out,
+		uint32_t index, size_t depth) const
+{
+	const auto& node = flat.nodes[index];
+	const auto indent = std::string(depth, '\t');
+
+	if (node.numValues == 0)
+	{
+		out << indent << "return " << static_cast<int>(node.type) << ";"
+			<< std::endl;
+	}
+	else if (node.numValues == ThresholdNode)
+	{
+		// Written this way round so NaN goes left, like in classifyFlat
+		out << indent << "if (point[" << node.attribute << "] > "
+			<< decimalLiteral(flat.thresholds[index]) << ")" << std::endl
+			<< indent << "{" << std::endl;
+		printSourceNode(out, flat.childTable[node.children + 1], depth + 1);
+		out << indent << "}" << std::endl
+			<< indent << "else" << std::endl
+			<< indent << "{" << std::endl;
+		printSourceNode(out, flat.childTable[node.children], depth + 1);
+		out << indent << "}" << std::endl;
+	}
+	else
+	{
+		// Values that aren't whole numbers, or are out of range, were
+		// never seen in training
+		const auto value = "point[" + std::to_string(node.attribute) + "]";
+		out << indent << "if (!(" << value << " >= 0 && " << value << " < "
+			<< node.numValues << ") || " << value
+			<< " != static_cast<int>(" << value << "))" << std::endl
+			<< indent << "{" << std::endl
+			<< indent << "\treturn " << static_cast<int>(NoType) << ";"
+			<< std::endl
+			<< indent << "}" << std::endl
+			<< indent << "switch (static_cast<int>(" << value << "))"
+			<< std::endl
+			<< indent << "{" << std::endl;
+		for (auto v = 0; v < node.numValues; ++v)
+		{
+			const auto child = flat.childTable[node.children + v];
+			if (child == NoChild)
+			{
+				continue;
+			}
+			out << indent << "case " << v << ":" << std::endl
+				<< indent << "{" << std::endl;
+			printSourceNode(out, child, depth + 1);
+			out << indent << "}" << std::endl;
+		}
+		out << indent << "default:" << std::endl
+			<< indent << "\treturn " << static_cast<int>(NoType) << ";"
+			<< std::endl
+			<< indent << "}" << std::endl;
+	}
+
+	return out;
 }
 
 /**
- * Calculates the entropy of a dataset by splitting it into two parts
- * based on class and seeing what proportion of the data belongs to each.
+ * The tree packed into arrays, in depth-first order.
  */
-double entropy(const TypeVector& types)
+const FlatTree& DecisionTree::getFlatTree() const
 {
-	assert(types.rows() > 0);
+	return flat;
+}
 
-	std::vector<uint8_t> sortedTypes(types.data(),
-			types.data() + types.rows());
-	std::sort(begin(sortedTypes), end(sortedTypes));
+/**
+ * Adds the node and everything under it to the tree's flat arrays, and
+ * gives the node's index.
+ */
+uint32_t DecisionTree::Node::flatten(DecisionTree& dt) const
+{
+	auto& flat = dt.flat;
+	const auto index = static_cast<uint32_t>(flat.nodes.size());
+	flat.nodes.push_back(FlatTreeNode{0, 0, 0, type});
+	dt.info.push_back(NodeInfo{nodeNumber, dataSize, dataEntropy});
+	if (dt.method == SplitMethod::BY_THRESHOLD)
+	{
+		flat.thresholds.push_back(threshold);
+	}
+	if (children.size() == 0)
+	{
+		return index;
+	}
+
+	// The table needs a slot for every value up to the largest one
+	size_t numValues = 0;
+	for (const auto& child : children)
+	{
+		numValues = std::max(numValues, child.parentAttrValue + 1);
+	}
+	assert(numValues < ThresholdNode);
 
-	double ret = 0;
-	auto currentType = sortedTypes[0];
-	auto currentTypeMatches = 0;
-	for (auto type : sortedTypes)
+	const auto table = static_cast<uint32_t>(flat.childTable.size());
+	flat.childTable.resize(table + numValues, NoChild);
+	flat.nodes[index] = FlatTreeNode{static_cast<uint32_t>(attributeIndex),
+		table, static_cast<uint16_t>(numValues), NoType};
+	if (dt.method == SplitMethod::BY_THRESHOLD)
 	{
-		if (currentType == type)
+		flat.nodes[index].numValues = ThresholdNode;
+	}
+
+	for (const auto& child : children)
+	{
+		// Flattening the child can grow the table, so don't hold on to
+		// a reference into it
+		const auto childIndex = child.flatten(dt);
+		flat.childTable[table + child.parentAttrValue] = childIndex;
+	}
+	return index;
+}
+
+/**
+ * Classifies a point with a flattened tree. Gives the same answer as
+ * DecisionTree::classify on the tree it came from.
+ */
+uint8_t classifyFlat(const FlatTreeNode* nodes, const uint32_t* childTable,
+		const Decimal* thresholds, const PointRef& point)
+{
+	const auto* node = nodes;
+	while (node->numValues > 0)
+	{
+		const auto value = point[node->attribute];
+		if (node->numValues == ThresholdNode)
 		{
-			++currentTypeMatches;
+			// Anything that isn't past the threshold goes left, even NaN
+			const auto right = value > thresholds[node - nodes];
+			node = nodes + childTable[node->children + right];
+			continue;
 		}
-		else
+
+		// Values the tree has no child for, including ones that aren't
+		// whole numbers, are values it never saw in training
+		if (!(value >= 0 && value < node->numValues))
+		{
+			return NoType;
+		}
+		const auto index = static_cast<uint32_t>(value);
+		const auto child = childTable[node->children + index];
+		if (index != value || child == NoChild)
 		{
-			// Every time we see a new class, add the entropy from the last one
-			auto p = static_cast<double>(currentTypeMatches) / types.rows();
-			ret -= (p) * log2(p);
-			currentTypeMatches = 1;
-			currentType = type;
+			return NoType;
 		}
+		node = nodes + child;
 	}
+	return node->type;
+}
 
-	// Add the entropy from the final class
-	auto p = static_cast<double>(currentTypeMatches) / types.rows();
-	ret -= p * log2(p);
+std::ostream& operator<<(std::ostream& out, const DecisionTree& dt)
+{
+	return dt.print(out);
+}
 
-	return ret;
+/**
+ * Calculates the entropy of a dataset by splitting it into two parts
+ * based on class and seeing what proportion of the data belongs to each.
+ */
+double entropy(const TypeVector& types)
+{
+	const auto rows = allRows(types.rows());
+	return entropy(types, cbegin(rows), cend(rows));
 }
 
 double entropy(const std::vector<uint8_t>& types)
@@ -297,6 +879,16 @@ double entropy(const std::vector<uint8_t>& types)
 	return entropy(tv);
 }
 
+/**
+ * Calculates the entropy of just the given rows.
+ */
+double entropy(const TypeRef& types,
+		std::vector<size_t>::const_iterator first,
+		std::vector<size_t>::const_iterator last)
+{
+	return tableFor(types, last - first).entropy(types, first, last);
+}
+
 /*
  * Calculates how many bits you will save by knowing the value of an attribute.
  * It's a measure of how well the given column of your data can predict
@@ -304,83 +896,155 @@ double entropy(const std::vector<uint8_t>& types)
  */
 double gain(const TypeVector& types, const ColVector& dataColumn)
 {
-	assert(types.rows() > 0);
 	assert(types.rows() == dataColumn.rows());
+	const auto rows = allRows(types.rows());
+	return gain(types, dataColumn, 0, cbegin(rows), cend(rows));
+}
 
-	// Find all the unique values in the column
-	auto uniqueValues = getUniqueValues(colToStdVector(dataColumn));
+/*
+ * Calculates the gain of a column using just the given rows.
+ */
+double gain(const TypeRef& types, const DataRef& data, size_t column,
+		std::vector<size_t>::const_iterator first,
+		std::vector<size_t>::const_iterator last)
+{
+	return tableFor(types, last - first).gain(types, data, column,
+			first, last);
+}
 
-	// Gain is entropy(types) - something per each unique value
-	double ret = entropy(types);
+/*
+ * Gives you the 0-based index of the column that maximizes information gain.
+ */
+size_t bestAttribute(const TypeVector& types, const DataMatrix& data)
+{
+	const auto rows = allRows(types.rows());
+	return bestAttribute(types, data, cbegin(rows), cend(rows));
+}
 
-	for (auto value : uniqueValues)
-	{
-		// Select all the data points where that column = that value
-		std::vector<uint8_t> subsetTypes;
-		for (auto i = 0; i < dataColumn.rows(); ++i)
-		{
-			if (dataColumn[i] == value)
-			{
-				subsetTypes.push_back(types[i]);
-			}
-		}
+/*
+ * Finds the best column using just the given rows.
+ */
+size_t bestAttribute(const TypeRef& types, const DataRef& data,
+		std::vector<size_t>::const_iterator first,
+		std::vector<size_t>::const_iterator last)
+{
+	return tableFor(types, last - first).bestAttribute(types, data,
+			first, last);
+}
 
-		assert(subsetTypes.size() > 0);
+/**
+ * Lists every row from 0 up to numRows.
+ */
+std::vector<size_t> allRows(size_t numRows)
+{
+	std::vector<size_t> rows(numRows);
+	std::iota(begin(rows), end(rows), 0);
+	return rows;
+}
+
+/**
+ * Makes a table big enough to work out gains for up to numRows of the
+ * given types.
+ */
+ContingencyTable tableFor(const TypeRef& types, size_t numRows)
+{
+	assert(types.rows() > 0);
+	return ContingencyTable{numRows, static_cast<size_t>(types.maxCoeff()) + 1};
+}
 
-		// Add the entropy gained by knowing that column = that value
-		ret -= static_cast<double>(subsetTypes.size())/dataColumn.rows()
-				* entropy(subsetTypes);
+/**
+ * The type most of the given rows have. Ties go to the smallest type.
+ */
+uint8_t mostCommonType(const TypeRef& types,
+		std::vector<size_t>::const_iterator first,
+		std::vector<size_t>::const_iterator last)
+{
+	std::array<size_t, NoType + 1> counts{};
+	for (auto row = first; row != last; ++row)
+	{
+		++counts[types[*row]];
 	}
+	return std::max_element(cbegin(counts), cend(counts)) - cbegin(counts);
+}
 
-	return ret;
+/**
+ * Steps a SplitMix64 generator and gives its next number. Unlike the
+ * standard library's distributions, this gives the same numbers on
+ * every platform, so a seed always builds the same tree.
+ */
+uint64_t nextRandom(uint64_t& state)
+{
+	auto z = (state += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
 }
 
-/*
- * Gives you the 0-based index of the column that maximizes information gain.
+/**
+ * What Decimal is called in C++ source.
  */
-size_t bestAttribute(const TypeVector& types, const DataMatrix& data)
+std::string decimalTypeName()
 {
-	double maxGain = -999;
-	size_t ret = 999;
-	for (auto i = 0; i < data.cols(); ++i)
+	if (std::is_same<Decimal, float>::value)
 	{
-		auto colGain = gain(types, data.col(i));
-		if (colGain > maxGain)
-		{
-			ret = i;
-			maxGain = colGain;
-		}
+		return "float";
 	}
-
-	// If none of the columns improved the entropy, we can't really say
-	// that there is a best column. Instead of defaulting to attribute 0,
-	// we return a special value.
-	if (maxGain == 0)
+	else if (std::is_same<Decimal, double>::value)
 	{
-		return NoAttrIndex;
+		return "double";
 	}
-
-	return ret;
+	assert((std::is_same<Decimal, long double>::value));
+	return "long double";
 }
 
-std::vector<uint8_t> colToStdVector(const ColVector& col)
+/**
+ * Writes a Decimal as a C++ literal of the same type, with the fewest
+ * digits that still read back as exactly the same number.
+ */
+std::string decimalLiteral(Decimal value)
 {
-	return std::vector<uint8_t>(col.data(), col.data() + col.rows());
-}
+	const auto suffix = std::is_same<Decimal, float>::value ? "f"
+			: std::is_same<Decimal, double>::value ? "" : "L";
 
-std::vector<uint8_t> rowToStdVector(const RowVector& row)
-{
-	return std::vector<uint8_t>(row.data(), row.data() + row.cols());
+	std::ostringstream literal{};
+	for (auto digits = std::numeric_limits<Decimal>::digits10;
+			digits <= std::numeric_limits<Decimal>::max_digits10; ++digits)
+	{
+		literal.str("");
+		literal << std::setprecision(digits) << value;
+		std::istringstream in{literal.str()};
+		Decimal readBack = 0;
+		in >> readBack;
+		if (readBack == value)
+		{
+			break;
+		}
+	}
+
+	// Whole numbers need a point to be floating point literals
+	auto ret = literal.str();
+	if (ret.find_first_of(".e") == std::string::npos)
+	{
+		ret += ".0";
+	}
+	return ret + suffix;
 }
 
 /**
- * Utility function to get the unique values from a vector.
- *
- * Unlike std::unique, data does not have to be in sorted order.
+ * Utility function to get the unique values in one column of the
+ * given rows, in sorted order.
  */
-std::vector<uint8_t> getUniqueValues(std::vector<uint8_t> vec)
+std::vector<uint8_t> getUniqueValues(const DataRef& data, size_t column,
+		std::vector<size_t>::const_iterator first,
+		std::vector<size_t>::const_iterator last)
 {
-	std::sort(begin(vec), end(vec));
-	vec.erase(std::unique(begin(vec), end(vec)), end(vec));
-	return vec;
+	std::vector<uint8_t> values{};
+	values.reserve(last - first);
+	for (auto row = first; row != last; ++row)
+	{
+		values.push_back(data(*row, column));
+	}
+	std::sort(begin(values), end(values));
+	values.erase(std::unique(begin(values), end(values)), end(values));
+	return values;
 }
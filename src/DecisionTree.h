@@ -9,56 +9,172 @@
 #define DECISIONTREE_H_
 
 #include "Classifier.h"
+#include "Types.h"
 #include <cstdint>
 #include <list>
 #include <memory>
+#include <vector>
 #include <iosfwd>
 #include <string>
+class DatasetView;
 
+/**
+ * How a tree splits up the rows at each node. BY_VALUE gives a node a
+ * child for every value of its attribute, so the data has to be
+ * discretized first. BY_THRESHOLD splits them in two, into the rows
+ * with values up to a threshold and the rest, so trees can be trained
+ * on raw data.
+ */
+enum class SplitMethod : uint8_t
+{
+	BY_VALUE,
+	BY_THRESHOLD
+};
+
+/**
+ * A node of a decision tree, packed into an array so the tree can be
+ * saved to a file and classified with straight from it. Leaves have no
+ * values and give their type. Other nodes look the point's value for
+ * their attribute up in a table of children: childTable[children + v]
+ * is the index of the node for value v, or NoChild if training never
+ * saw that value.
+ *
+ * Nodes that split on a threshold have ThresholdNode values instead,
+ * and two children: childTable[children] for points with values up to
+ * the node's threshold, and childTable[children + 1] for the rest.
+ */
+struct FlatTreeNode
+{
+	uint32_t attribute;
+	uint32_t children;
+	uint16_t numValues;
+	uint8_t type;
+};
+
+constexpr uint32_t NoChild = UINT32_MAX;
+constexpr uint16_t ThresholdNode = UINT16_MAX;
+
+/**
+ * A whole decision tree packed into arrays. The root is node 0.
+ * Thresholds are only kept for trees that split on them, one for every
+ * node, and are 0 for nodes that don't have one.
+ */
+struct FlatTree
+{
+	std::vector<FlatTreeNode> nodes;
+	std::vector<uint32_t> childTable;
+	std::vector<Decimal> thresholds;
+};
+
+/**
+ * A decision tree is built out of Nodes, but once it's built they're
+ * packed into a FlatTree, and that's all classify looks at: a few
+ * loads from two arrays per level of the tree. The sizes and entropies
+ * only the graph output needs are kept off to the side.
+ *
+ * Trees that split on thresholds sort the rows by every column once, up
+ * front, and each node keeps its rows in the same stretch of all those
+ * sorted lists. That way the best threshold for a column is found in
+ * one pass down its list, and splitting a node only has to shuffle each
+ * list's stretch into two, keeping it sorted.
+ *
+ * Given more than one thread, subtrees are built in parallel, and so
+ * are the gains of every column for nodes with lots of rows. Nodes are
+ * numbered once the whole tree is built, in the same order building it
+ * on one thread would have, so the graph output doesn't depend on how
+ * many threads there were.
+ */
 class DecisionTree : public Classifier
 {
 public:
-	explicit DecisionTree(const TypeVector& types,
-			const DataMatrix& data);
-	uint8_t classify(const RowVector& dataPoint) const override;
+	explicit DecisionTree(const TypeRef& types, const DataRef& data,
+			SplitMethod method = SplitMethod::BY_VALUE,
+			unsigned int numThreads = 1);
+	explicit DecisionTree(const DatasetView& view,
+			SplitMethod method = SplitMethod::BY_VALUE,
+			unsigned int numThreads = 1);
+	explicit DecisionTree(const TypeRef& types, const DataRef& data,
+			std::vector<std::vector<size_t>> sortedRows,
+			size_t attributesPerNode, uint64_t seed);
+	using Classifier::classify;
+	uint8_t classify(const PointRef& dataPoint) const override;
 	std::ostream& print(std::ostream& out) const;
+	std::ostream& printSource(std::ostream& out,
+			const std::string& functionName = "classifyPoint") const;
+	const FlatTree& getFlatTree() const;
 
 private:
+	struct Builder;
+
 	struct Node
 	{
 	public:
-		explicit Node(const TypeVector& types, const DataMatrix& data,
-				DecisionTree& dt);
 		explicit Node(size_t parentAttrValue, const Node* parent,
-				const TypeVector& types, const DataMatrix& data,
-				size_t attributesChecked, DecisionTree& dt);
-		std::ostream& print(std::ostream& out) const;
+				size_t attributesChecked);
+		void build(Builder& builder, size_t worker,
+				std::vector<size_t>::iterator first,
+				std::vector<size_t>::iterator last);
+		void split(Builder& builder, size_t worker, size_t first,
+				size_t last);
+		size_t number(size_t next);
+		uint32_t flatten(DecisionTree& dt) const;
 
 		// Set by parent
 		size_t parentAttrValue;
 		const Node* parent;
 		size_t attributesChecked;
 		size_t nodeNumber; // Used for graph output
+		uint64_t seed; // Used for picking attributes at random
 
 		// Calculated
 		std::list<Node> children;
 		size_t attributeIndex;
+		Decimal threshold;
 		uint8_t type;
 		size_t dataSize; // Used for graph output
 		double dataEntropy; // Used for graph output
 	};
 	friend Node;
 
-	std::unique_ptr<Node> root;
+	// What the graph output shows about each node of the flat tree
+	struct NodeInfo
+	{
+		size_t nodeNumber;
+		size_t dataSize;
+		double dataEntropy;
+	};
+
+	void build(const TypeRef& types, const DataRef& data,
+			std::vector<size_t>& rows, unsigned int numThreads,
+			size_t attributesPerNode, uint64_t seed,
+			std::vector<std::vector<size_t>> sortedRows);
+	std::ostream& printNode(std::ostream& out, uint32_t index) const;
+	std::ostream& printSourceNode(std::ostream& out, uint32_t index,
+			size_t depth) const;
+
+	SplitMethod method;
 	size_t nodeCount;
+	FlatTree flat;
+	std::vector<NodeInfo> info;
 };
 
 double entropy(const TypeVector& types);
 double entropy(const std::vector<uint8_t>& types);
+double entropy(const TypeRef& types,
+		std::vector<size_t>::const_iterator first,
+		std::vector<size_t>::const_iterator last);
 double gain(const TypeVector& types,
 		const ColVector& dataColumn);
+double gain(const TypeRef& types, const DataRef& data, size_t column,
+		std::vector<size_t>::const_iterator first,
+		std::vector<size_t>::const_iterator last);
 size_t bestAttribute(const TypeVector& types,
 		const DataMatrix& data);
+size_t bestAttribute(const TypeRef& types, const DataRef& data,
+		std::vector<size_t>::const_iterator first,
+		std::vector<size_t>::const_iterator last);
+uint8_t classifyFlat(const FlatTreeNode* nodes, const uint32_t* childTable,
+		const Decimal* thresholds, const PointRef& point);
 std::ostream& operator<<(std::ostream& out, const DecisionTree& dt);
 
 #endif /* DECISIONTREE_H_ */
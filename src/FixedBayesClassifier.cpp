@@ -0,0 +1,51 @@
+/*
+ * FixedBayesClassifier.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#include "FixedBayesClassifier.h"
+
+/**
+ * Makes a FixedBayesClassifier, in memory aligned the way Eigen needs.
+ */
+template <int Fields, int Classes>
+static std::shared_ptr<Classifier> makeFixed(const BayesClassifier& bayes)
+{
+	using Fixed = FixedBayesClassifier<Fields, Classes>;
+	return std::allocate_shared<Fixed>(Eigen::aligned_allocator<Fixed>{},
+			bayes);
+}
+
+/**
+ * Swaps a Bayes classifier for a FixedBayesClassifier if its data looks
+ * like one of the datasets we know the size of. Anything else, including
+ * other kinds of classifier, is given back as it is.
+ */
+std::shared_ptr<Classifier> specialize(std::shared_ptr<Classifier> classifier)
+{
+	auto bayes = std::dynamic_pointer_cast<BayesClassifier>(classifier);
+	if (!bayes)
+	{
+		return classifier;
+	}
+
+	const auto numClasses = bayes->getModels().size();
+	const auto numFields = bayes->getModels().front().getMean().cols();
+
+	if (numFields == IrisFields && numClasses == IrisClasses)
+	{
+		return makeFixed<IrisFields, IrisClasses>(*bayes);
+	}
+	if (numFields == WineFields && numClasses == WineClasses)
+	{
+		return makeFixed<WineFields, WineClasses>(*bayes);
+	}
+	if (numFields == HeartDiseaseFields && numClasses == HeartDiseaseClasses)
+	{
+		return makeFixed<HeartDiseaseFields, HeartDiseaseClasses>(*bayes);
+	}
+
+	return classifier;
+}
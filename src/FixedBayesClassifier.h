@@ -0,0 +1,190 @@
+/*
+ * FixedBayesClassifier.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#ifndef FIXEDBAYESCLASSIFIER_H_
+#define FIXEDBAYESCLASSIFIER_H_
+
+#include "BayesClassifier.h"
+#include "Classifier.h"
+#include "Types.h"
+#include <array>
+#include <cassert>
+#include <memory>
+
+/**
+ * A Bayes classifier for data whose number of fields and classes we
+ * know at compile time, like the iris, wine and heart disease data.
+ * Every vector and matrix has a fixed size, so Eigen keeps them on the
+ * stack and unrolls the loops over them, and classifying a point never
+ * touches the heap.
+ *
+ * It's built from an ordinary BayesClassifier, and gives the same
+ * answers. Naive and linear Bayes models only need one field at a time,
+ * so when every class is diagonal (or the identity) it keeps each
+ * class's inverse variances (or nothing) instead of a whitening matrix.
+ * Like any class holding fixed-size Eigen members, it has to be
+ * allocated with Eigen's aligned allocator.
+ */
+template <int Fields, int Classes>
+class FixedBayesClassifier: public Classifier
+{
+public:
+	using Point = Eigen::Matrix<Decimal, 1, Fields>;
+	using Whitening = Eigen::Matrix<Decimal, Fields, Fields>;
+	using Scores = Eigen::Matrix<Decimal, Classes, 1>;
+
+public:
+	explicit FixedBayesClassifier(const BayesClassifier& classifier);
+	using Classifier::classify;
+	uint8_t classify(const PointRef& point) const override;
+	uint8_t classify(const PointRef& point, ClassifierWorkspace& workspace,
+			Decimal& margin) const override;
+	TypeVector classifyBatch(const DataRef& points) const override;
+	template <typename Derived>
+	Scores getScores(const Eigen::MatrixBase<Derived>& point) const;
+
+private:
+	using Shape = GaussianModel::Shape;
+
+	// IDENTITY or DIAGONAL if every class is, otherwise FULL, which is
+	// scored with the whitening matrices
+	Shape shape;
+
+	std::array<Point, Classes> means;
+
+	// Each class's whitening matrix, padded out with rows of zeros if
+	// the class's covariance was singular. Only full models have these.
+	std::array<Whitening, Classes> whitenings;
+
+	// Each class's inverse variances, for diagonal models
+	std::array<Point, Classes> inverseVariances;
+
+	Scores logDeterminants;
+
+public:
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+template <int Fields, int Classes>
+FixedBayesClassifier<Fields, Classes>::FixedBayesClassifier(
+		const BayesClassifier& classifier)
+: shape{Shape::FULL},
+  means{},
+  whitenings{},
+  inverseVariances{},
+  logDeterminants{}
+{
+	const auto& models = classifier.getModels();
+	assert(models.size() == Classes);
+
+	shape = models[0].getShape();
+	for (const auto& model : models)
+	{
+		if (model.getShape() != shape)
+		{
+			shape = Shape::FULL;
+		}
+	}
+	if (shape == Shape::SINGULAR)
+	{
+		shape = Shape::FULL;
+	}
+
+	for (auto c = 0; c < Classes; ++c)
+	{
+		assert(models[c].getMean().cols() == Fields);
+		means[c] = models[c].getMean();
+
+		if (shape == Shape::DIAGONAL)
+		{
+			inverseVariances[c] = models[c].getInverseVariances();
+		}
+		else if (shape == Shape::FULL)
+		{
+			auto whitening = models[c].getWhitening();
+			whitenings[c].setZero();
+			whitenings[c].topRows(whitening.rows()) = whitening;
+		}
+
+		logDeterminants[c] = models[c].getLogDeterminant();
+	}
+}
+
+template <int Fields, int Classes>
+uint8_t FixedBayesClassifier<Fields, Classes>::classify(
+		const PointRef& point) const
+{
+	assert(point.cols() == Fields);
+
+	// Types start at index 1, but vectors at index 0
+	Eigen::Index best;
+	getScores(point).maxCoeff(&best);
+	return best + 1;
+}
+
+template <int Fields, int Classes>
+uint8_t FixedBayesClassifier<Fields, Classes>::classify(
+		const PointRef& point, ClassifierWorkspace&, Decimal& margin) const
+{
+	assert(point.cols() == Fields);
+	return bestScore(getScores(point), margin);
+}
+
+template <int Fields, int Classes>
+TypeVector FixedBayesClassifier<Fields, Classes>::classifyBatch(
+		const DataRef& points) const
+{
+	assert(points.cols() == Fields);
+
+	TypeVector types(points.rows());
+	for (auto i = 0; i < points.rows(); ++i)
+	{
+		Eigen::Index best;
+		getScores(points.row(i)).maxCoeff(&best);
+		types[i] = best + 1;
+	}
+	return types;
+}
+
+/**
+ * Same as BayesClassifier::getScores, for one point. Distances are
+ * worked out the same way GaussianModel::distance does for each shape.
+ */
+template <int Fields, int Classes>
+template <typename Derived>
+typename FixedBayesClassifier<Fields, Classes>::Scores
+FixedBayesClassifier<Fields, Classes>::getScores(
+		const Eigen::MatrixBase<Derived>& point) const
+{
+	const Point fixedPoint = point;
+
+	Scores scores;
+	for (auto c = 0; c < Classes; ++c)
+	{
+		const Point offset = fixedPoint - means[c];
+		Decimal distance;
+		switch (shape)
+		{
+		case Shape::IDENTITY:
+			distance = offset.squaredNorm();
+			break;
+		case Shape::DIAGONAL:
+			distance = (offset.array().square()
+					* inverseVariances[c].array()).sum();
+			break;
+		default:
+			distance = (whitenings[c] * offset.transpose()).squaredNorm();
+			break;
+		}
+		scores[c] = -logDeterminants[c] - distance;
+	}
+	return scores;
+}
+
+std::shared_ptr<Classifier> specialize(std::shared_ptr<Classifier> classifier);
+
+#endif /* FIXEDBAYESCLASSIFIER_H_ */
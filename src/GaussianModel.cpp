@@ -0,0 +1,315 @@
+/*
+ * GaussianModel.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#include "GaussianModel.h"
+#include <eigen3/Eigen/Eigenvalues>
+#include <cassert>
+#include <cmath>
+
+// Variances smaller than this are probably rounding errors
+constexpr Decimal MinVariance = .00000001;
+
+GaussianModel::GaussianModel(RowVector mean,
+		const CovarianceMatrix& covariance)
+: shape{Shape::FULL},
+  mean{std::move(mean)},
+  scale{1},
+  cholesky{covariance},
+  whitening{},
+  inverseVariances{},
+  logDeterminant{0}
+{
+	assert(covariance.rows() == this->mean.cols());
+	assert(covariance.cols() == this->mean.cols());
+
+	if (cholesky.info() != Eigen::Success || !updateLogDeterminant())
+	{
+		factorSingular(covariance);
+	}
+}
+
+/**
+ * Initialize a model with a diagonal covariance matrix.
+ */
+GaussianModel::GaussianModel(RowVector mean, const DiagonalMatrix& covariance)
+: shape{Shape::DIAGONAL},
+  mean{std::move(mean)},
+  scale{1},
+  cholesky{},
+  whitening{},
+  inverseVariances{},
+  logDeterminant{0}
+{
+	assert(covariance.cols() == this->mean.cols());
+	setVariances(covariance.diagonal().transpose());
+}
+
+/**
+ * Initialize a model whose covariance matrix is the identity.
+ */
+GaussianModel::GaussianModel(RowVector mean)
+: shape{Shape::IDENTITY},
+  mean{std::move(mean)},
+  scale{1},
+  cholesky{},
+  whitening{},
+  inverseVariances{},
+  logDeterminant{0}
+{
+}
+
+/**
+ * Fills in the inverse variances of a diagonal model. Variances too
+ * small to trust are left out, like a pseudo-inverse would. Returns
+ * false if there were any.
+ */
+bool GaussianModel::setVariances(const RowVector& variances)
+{
+	auto allKept = true;
+	inverseVariances.resize(variances.cols());
+	logDeterminant = 0;
+	for (auto j = 0; j < variances.cols(); ++j)
+	{
+		if (variances[j] > MinVariance)
+		{
+			inverseVariances[j] = 1 / variances[j];
+			logDeterminant += std::log(variances[j]);
+		}
+		else
+		{
+			inverseVariances[j] = 0;
+			allKept = false;
+		}
+	}
+	return allKept;
+}
+
+/**
+ * Works out the whitening rows from the eigenvectors of a covariance
+ * matrix that Cholesky couldn't handle.
+ */
+void GaussianModel::factorSingular(const CovarianceMatrix& covariance)
+{
+	Eigen::SelfAdjointEigenSolver<CovarianceMatrix> eigen{covariance};
+	const auto& values = eigen.eigenvalues();
+
+	auto rank = 0;
+	for (auto i = 0; i < values.rows(); ++i)
+	{
+		if (values[i] > MinVariance)
+		{
+			++rank;
+		}
+	}
+
+	shape = Shape::SINGULAR;
+	scale = 1;
+	logDeterminant = 0;
+	whitening.resize(rank, covariance.cols());
+	for (auto i = 0, row = 0; i < values.rows(); ++i)
+	{
+		if (values[i] > MinVariance)
+		{
+			whitening.row(row++) = eigen.eigenvectors().col(i).transpose()
+					/ std::sqrt(values[i]);
+			logDeterminant += std::log(values[i]);
+		}
+	}
+}
+
+/**
+ * Works out the log determinant from the Cholesky factor. Returns false
+ * if the covariance is too close to singular to trust the factor.
+ */
+bool GaussianModel::updateLogDeterminant()
+{
+	const auto& factor = cholesky.matrixLLT();
+	logDeterminant = factor.rows() * std::log(scale);
+	for (auto i = 0; i < factor.rows(); ++i)
+	{
+		const auto variance = scale * factor(i, i) * factor(i, i);
+		if (!(variance > MinVariance))
+		{
+			return false;
+		}
+		logDeterminant += 2 * std::log(factor(i, i));
+	}
+	return true;
+}
+
+/**
+ * The squared Mahalanobis distance from the mean to a point.
+ */
+Decimal GaussianModel::distance(const PointRef& point) const
+{
+	ColVector offset{};
+	return distance(point, offset);
+}
+
+/**
+ * Same as distance(point), but works in offset instead of allocating
+ * its own space, so calling it over and over is cheaper.
+ */
+Decimal GaussianModel::distance(const PointRef& point,
+		ColVector& offset) const
+{
+	switch (shape)
+	{
+	case Shape::IDENTITY:
+		return (point - mean).squaredNorm();
+	case Shape::DIAGONAL:
+		return ((point - mean).array().square()
+				* inverseVariances.array()).sum();
+	case Shape::SINGULAR:
+		offset = (point - mean).transpose();
+		return whitening.lazyProduct(offset).squaredNorm();
+	default:
+		offset = (point - mean).transpose();
+		cholesky.matrixL().solveInPlace(offset);
+		return offset.squaredNorm() / scale;
+	}
+}
+
+/**
+ * Works out the distance to every row of points at once, and puts them
+ * in out. Solving for all the points together lets Eigen use matrix-
+ * matrix products, which is a lot faster than doing them one at a time.
+ * offsets is used as workspace.
+ */
+void GaussianModel::distances(const DataRef& points, DataMatrix& offsets,
+		Eigen::Ref<ColVector> out) const
+{
+	assert(out.rows() == points.rows());
+
+	switch (shape)
+	{
+	case Shape::IDENTITY:
+		out = (points.rowwise() - mean).rowwise().squaredNorm();
+		break;
+	case Shape::DIAGONAL:
+		out = ((points.rowwise() - mean).array().square().rowwise()
+				* inverseVariances.array()).rowwise().sum().matrix();
+		break;
+	case Shape::SINGULAR:
+		offsets = (points.rowwise() - mean).transpose();
+		out = (whitening * offsets).colwise().squaredNorm().transpose();
+		break;
+	default:
+		offsets = (points.rowwise() - mean).transpose();
+		cholesky.matrixL().solveInPlace(offsets);
+		out = offsets.colwise().squaredNorm().transpose() / scale;
+		break;
+	}
+}
+
+/**
+ * Gives a matrix W that turns offsets from the mean into independent,
+ * unit-variance coordinates, so distance(x) = |W * (x - mean)'|^2.
+ * Each row is one of those coordinates, and singular models have fewer
+ * rows than fields.
+ *
+ * For a full covariance this is the inverse of the Cholesky factor,
+ * which is lower triangular.
+ */
+DataMatrix GaussianModel::getWhitening() const
+{
+	const auto numFields = mean.cols();
+	switch (shape)
+	{
+	case Shape::IDENTITY:
+		return DataMatrix::Identity(numFields, numFields);
+	case Shape::DIAGONAL:
+		return inverseVariances.cwiseSqrt().asDiagonal();
+	case Shape::SINGULAR:
+		return whitening;
+	default:
+		return cholesky.matrixL().solve(
+				DataMatrix::Identity(numFields, numFields))
+			/ std::sqrt(scale);
+	}
+}
+
+Decimal GaussianModel::getLogDeterminant() const
+{
+	return logDeterminant;
+}
+
+/**
+ * One over the variance of each field, or 0 for fields with no
+ * variance. Only diagonal models have these.
+ */
+const RowVector& GaussianModel::getInverseVariances() const
+{
+	assert(shape == Shape::DIAGONAL);
+	return inverseVariances;
+}
+
+const RowVector& GaussianModel::getMean() const
+{
+	return mean;
+}
+
+GaussianModel::Shape GaussianModel::getShape() const
+{
+	return shape;
+}
+
+bool GaussianModel::isSingular() const
+{
+	return shape == Shape::SINGULAR || (shape == Shape::DIAGONAL
+			&& (inverseVariances.array() == 0).any());
+}
+
+/**
+ * Takes one of the points the model was fit to back out, in O(d^2)
+ * time, where count is how many points it was fit to. The covariance
+ * has to be the sample covariance of those points.
+ *
+ * Taking a point x out moves the mean by -u/(n-1), where u = x - mean,
+ * and turns the covariance C into
+ *
+ *     (n-1)/(n-2) * (C - v*u'*u),   v = n/(n-1)^2
+ *
+ * which is a rank one downdate of the Cholesky factor. Diagonal models
+ * only keep the diagonal of that, and identity models just move.
+ *
+ * Returns false, and leaves the model in a mess, if that can't be done,
+ * which happens if the model is singular or would become singular. Then
+ * the model has to be fit again from scratch.
+ */
+bool GaussianModel::removePoint(const RowVector& point, size_t count)
+{
+	if (isSingular() || count <= 2)
+	{
+		return false;
+	}
+
+	const auto n = static_cast<Decimal>(count);
+	RowVector u = point - mean;
+	mean -= u / (n - 1);
+
+	if (shape == Shape::IDENTITY)
+	{
+		return true;
+	}
+	if (shape == Shape::DIAGONAL)
+	{
+		RowVector variances = (n - 1) / (n - 2)
+			* (inverseVariances.array().inverse()
+				- n / ((n - 1) * (n - 1)) * u.array().square()).matrix();
+		return setVariances(variances);
+	}
+
+	cholesky.rankUpdate(u.transpose(), -n / ((n - 1) * (n - 1)) / scale);
+	if (cholesky.info() != Eigen::Success)
+	{
+		return false;
+	}
+
+	scale *= (n - 1) / (n - 2);
+	return updateLogDeterminant();
+}
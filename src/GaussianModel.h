@@ -0,0 +1,77 @@
+/*
+ * GaussianModel.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#ifndef GAUSSIANMODEL_H_
+#define GAUSSIANMODEL_H_
+
+#include "Types.h"
+#include <cstdint>
+#include <eigen3/Eigen/Cholesky>
+
+/**
+ * The normal distribution a Bayes classifier fits to one class: its
+ * mean, and a factorization of its covariance matrix.
+ *
+ * The covariance is kept as scale * L * L', with L the Cholesky factor,
+ * so measuring how far a point is from the mean is a triangular solve
+ * instead of a multiply by a dense inverse. The log of the determinant
+ * falls out of L's diagonal, so it can't overflow the way multiplying
+ * out the determinant can.
+ *
+ * A covariance matrix that isn't positive definite can't be factored
+ * like that. Then we fall back to its eigenvectors, and ignore the
+ * directions with no variance, the same as a pseudo-inverse would.
+ *
+ * Naive and linear Bayes don't need any of that. Their covariances are
+ * diagonal or the identity, so those models only keep the inverse of
+ * each variance, or nothing at all, and measure distances one field at
+ * a time.
+ */
+class GaussianModel
+{
+public:
+	enum class Shape : uint32_t {FULL, SINGULAR, DIAGONAL, IDENTITY};
+
+public:
+	explicit GaussianModel(RowVector mean, const CovarianceMatrix& covariance);
+	explicit GaussianModel(RowVector mean, const DiagonalMatrix& covariance);
+	explicit GaussianModel(RowVector mean);
+	Decimal distance(const PointRef& point) const;
+	Decimal distance(const PointRef& point, ColVector& offset) const;
+	void distances(const DataRef& points, DataMatrix& offsets,
+			Eigen::Ref<ColVector> out) const;
+	Decimal getLogDeterminant() const;
+	DataMatrix getWhitening() const;
+	const RowVector& getInverseVariances() const;
+	const RowVector& getMean() const;
+	Shape getShape() const;
+	bool isSingular() const;
+	bool removePoint(const RowVector& point, size_t count);
+
+private:
+	void factorSingular(const CovarianceMatrix& covariance);
+	bool updateLogDeterminant();
+	bool setVariances(const RowVector& variances);
+
+	Shape shape;
+	RowVector mean;
+	Decimal scale;
+	Eigen::LLT<CovarianceMatrix> cholesky;
+
+	// For singular covariances, rows that project a point onto the
+	// directions that have some variance, already divided by their
+	// standard deviations
+	DataMatrix whitening;
+
+	// For diagonal covariances, one over each variance, or 0 for fields
+	// with no variance
+	RowVector inverseVariances;
+
+	Decimal logDeterminant;
+};
+
+#endif /* GAUSSIANMODEL_H_ */
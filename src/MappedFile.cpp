@@ -0,0 +1,124 @@
+/*
+ * MappedFile.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#include "MappedFile.h"
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Throws a std::runtime_error saying what went wrong with the file,
+ * going by errno.
+ */
+static void fail(const std::string& what, const std::string& filename)
+{
+	throw std::runtime_error{"Can't " + what + " " + filename + ": "
+		+ std::strerror(errno)};
+}
+
+/**
+ * Maps a file. Files that can't be opened or mapped throw
+ * std::runtime_error.
+ */
+MappedFile::MappedFile(const std::string& filename)
+: contents{nullptr},
+  length{0}
+{
+	auto fd = open(filename.c_str(), O_RDONLY);
+	if (fd == -1)
+	{
+		fail("open", filename);
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0)
+	{
+		const auto error = errno;
+		close(fd);
+		errno = error;
+		fail("stat", filename);
+	}
+	length = static_cast<size_t>(info.st_size);
+
+	// Zero-length mappings aren't allowed, so an empty file just has
+	// an empty range of contents.
+	if (length > 0)
+	{
+		auto mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping == MAP_FAILED)
+		{
+			const auto error = errno;
+			close(fd);
+			errno = error;
+			fail("map", filename);
+		}
+		contents = static_cast<const char*>(mapping);
+	}
+
+	close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+	if (contents != nullptr)
+	{
+		munmap(const_cast<char*>(contents), length);
+	}
+}
+
+const char* MappedFile::begin() const
+{
+	return contents;
+}
+
+const char* MappedFile::end() const
+{
+	return contents + length;
+}
+
+size_t MappedFile::size() const
+{
+	return length;
+}
+
+/**
+ * Tells the operating system we're going to read the file front to back,
+ * so it can read ahead. Files that are read in any order (like binary
+ * datasets) shouldn't ask for this.
+ */
+void MappedFile::adviseSequential() const
+{
+	if (contents != nullptr)
+	{
+		madvise(const_cast<char*>(contents), length, MADV_SEQUENTIAL);
+	}
+}
+
+/**
+ * Lets the operating system drop the pages in [from, to) from memory,
+ * for when we're done with them. They will be read back in from the file
+ * if they are used again. Partial pages at either end are kept.
+ */
+void MappedFile::discard(const char* from, const char* to)
+{
+	assert(begin() <= from && from <= to && to <= end());
+
+	const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	auto firstPage = (from - contents + pageSize - 1) / pageSize * pageSize;
+	auto lastPage = (to - contents) / pageSize * pageSize;
+
+	if (firstPage < lastPage)
+	{
+		madvise(const_cast<char*>(contents) + firstPage,
+				lastPage - firstPage, MADV_DONTNEED);
+	}
+}
@@ -0,0 +1,37 @@
+/*
+ * MappedFile.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Read-only memory mapping of an entire file. The contents stay valid
+ * for as long as the object is alive. Files that can't be opened or
+ * mapped throw std::runtime_error.
+ */
+class MappedFile
+{
+public:
+	explicit MappedFile(const std::string& filename);
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile();
+	const char* begin() const;
+	const char* end() const;
+	size_t size() const;
+	void adviseSequential() const;
+	void discard(const char* from, const char* to);
+
+private:
+	const char* contents;
+	size_t length;
+};
+
+#endif /* MAPPEDFILE_H_ */
@@ -0,0 +1,564 @@
+/*
+ * ModelFile.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#include "ModelFile.h"
+#include "BayesClassifier.h"
+#include "DecisionTree.h"
+#include "GaussianModel.h"
+#include "MappedFile.h"
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+static const char ModelFileMagic[8] = "CLSMODL";
+
+/**
+ * Rounds an offset up to the start of the next section.
+ */
+static uint64_t align(uint64_t offset)
+{
+	return (offset + ModelFileAlignment - 1)
+			/ ModelFileAlignment * ModelFileAlignment;
+}
+
+/**
+ * Pads the file with zeros until it reaches the given offset.
+ */
+static void padTo(std::ofstream& out, uint64_t offset)
+{
+	static const char zeros[ModelFileAlignment] = {};
+	auto position = static_cast<uint64_t>(out.tellp());
+	assert(position <= offset && offset - position < ModelFileAlignment);
+	out.write(zeros, offset - position);
+}
+
+static ModelFileHeader emptyHeader(ModelKind kind)
+{
+	ModelFileHeader header{};
+	std::memcpy(header.magic, ModelFileMagic, sizeof(header.magic));
+	header.version = ModelFileVersion;
+	header.decimalSize = sizeof(Decimal);
+	header.kind = kind;
+	return header;
+}
+
+/**
+ * How many Decimals a class's whitening takes up in a model file.
+ */
+static uint64_t whiteningSize(GaussianModel::Shape shape, uint64_t numFields)
+{
+	switch (shape)
+	{
+	case GaussianModel::Shape::IDENTITY:
+		return 0;
+	case GaussianModel::Shape::DIAGONAL:
+		return numFields;
+	default:
+		return numFields * numFields;
+	}
+}
+
+/**
+ * Saves the parts of a Bayes classifier it needs to score points: each
+ * class's mean, shape, whitening and log determinant. Diagonal models
+ * only save their inverse variances, and identity models nothing.
+ * Whitening matrices of singular models are padded out with rows of
+ * zeros, so every full matrix is the same size.
+ */
+static void saveBayes(const BayesClassifier& classifier, std::ofstream& out)
+{
+	const auto& models = classifier.getModels();
+	assert(models.size() > 0);
+	const auto numFields = models[0].getMean().cols();
+	const auto numClasses = models.size();
+
+	uint64_t numWhitening = 0;
+	for (const auto& model : models)
+	{
+		numWhitening += whiteningSize(model.getShape(), numFields);
+	}
+
+	auto header = emptyHeader(ModelKind::BAYES);
+	header.numFields = numFields;
+	header.numClasses = numClasses;
+	header.meansOffset = align(sizeof(header));
+	header.shapesOffset = align(header.meansOffset
+			+ numFields * numClasses * sizeof(Decimal));
+	header.whiteningsOffset = align(header.shapesOffset
+			+ numClasses * sizeof(uint32_t));
+	header.logDeterminantsOffset = align(header.whiteningsOffset
+			+ numWhitening * sizeof(Decimal));
+	header.fileSize = header.logDeterminantsOffset
+			+ numClasses * sizeof(Decimal);
+
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	padTo(out, header.meansOffset);
+	for (const auto& model : models)
+	{
+		assert(model.getMean().cols() == numFields);
+		out.write(reinterpret_cast<const char*>(model.getMean().data()),
+				numFields * sizeof(Decimal));
+	}
+
+	padTo(out, header.shapesOffset);
+	for (const auto& model : models)
+	{
+		const auto shape = model.getShape();
+		out.write(reinterpret_cast<const char*>(&shape), sizeof(uint32_t));
+	}
+
+	padTo(out, header.whiteningsOffset);
+	DataMatrix whitening(numFields, numFields);
+	for (const auto& model : models)
+	{
+		switch (model.getShape())
+		{
+		case GaussianModel::Shape::IDENTITY:
+			break;
+		case GaussianModel::Shape::DIAGONAL:
+			out.write(reinterpret_cast<const char*>(
+					model.getInverseVariances().data()),
+					numFields * sizeof(Decimal));
+			break;
+		default:
+		{
+			auto modelWhitening = model.getWhitening();
+			whitening.setZero();
+			whitening.topRows(modelWhitening.rows()) = modelWhitening;
+			out.write(reinterpret_cast<const char*>(whitening.data()),
+					whitening.size() * sizeof(Decimal));
+			break;
+		}
+		}
+	}
+
+	padTo(out, header.logDeterminantsOffset);
+	for (const auto& model : models)
+	{
+		const auto logDeterminant = model.getLogDeterminant();
+		out.write(reinterpret_cast<const char*>(&logDeterminant),
+				sizeof(Decimal));
+	}
+
+	assert(static_cast<uint64_t>(out.tellp()) == header.fileSize);
+}
+
+static void saveTree(const DecisionTree& tree, std::ofstream& out)
+{
+	const auto& flat = tree.getFlatTree();
+
+	auto header = emptyHeader(ModelKind::DECISION_TREE);
+	header.numNodes = flat.nodes.size();
+	header.numChildren = flat.childTable.size();
+	header.nodesOffset = align(sizeof(header));
+	header.childTableOffset = align(header.nodesOffset
+			+ flat.nodes.size() * sizeof(FlatTreeNode));
+	header.fileSize = header.childTableOffset
+			+ flat.childTable.size() * sizeof(uint32_t);
+	if (flat.thresholds.size() > 0)
+	{
+		assert(flat.thresholds.size() == flat.nodes.size());
+		header.numThresholds = flat.thresholds.size();
+		header.thresholdsOffset = align(header.fileSize);
+		header.fileSize = header.thresholdsOffset
+				+ flat.thresholds.size() * sizeof(Decimal);
+	}
+
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	padTo(out, header.nodesOffset);
+	out.write(reinterpret_cast<const char*>(flat.nodes.data()),
+			flat.nodes.size() * sizeof(FlatTreeNode));
+
+	padTo(out, header.childTableOffset);
+	out.write(reinterpret_cast<const char*>(flat.childTable.data()),
+			flat.childTable.size() * sizeof(uint32_t));
+
+	if (header.numThresholds > 0)
+	{
+		padTo(out, header.thresholdsOffset);
+		out.write(reinterpret_cast<const char*>(flat.thresholds.data()),
+				flat.thresholds.size() * sizeof(Decimal));
+	}
+
+	assert(static_cast<uint64_t>(out.tellp()) == header.fileSize);
+}
+
+/**
+ * Saves a Bayes classifier or a decision tree, so another process can
+ * load it with loadModel instead of training its own. Other classifiers
+ * can't be saved, and throw std::invalid_argument before the file is
+ * touched.
+ */
+void saveModel(const Classifier& classifier, std::string filename)
+{
+	auto bayes = dynamic_cast<const BayesClassifier*>(&classifier);
+	auto tree = dynamic_cast<const DecisionTree*>(&classifier);
+	if (bayes == nullptr && tree == nullptr)
+	{
+		throw std::invalid_argument{
+			"Only Bayes classifiers and decision trees can be saved"};
+	}
+
+	auto out = std::ofstream{filename, std::ios::binary | std::ios::trunc};
+	if (!out.is_open())
+	{
+		throw std::runtime_error{"Can't open " + filename + " for writing"};
+	}
+
+	if (bayes != nullptr)
+	{
+		saveBayes(*bayes, out);
+	}
+	else
+	{
+		saveTree(*tree, out);
+	}
+
+	if (!out.good())
+	{
+		throw std::runtime_error{"Couldn't write " + filename};
+	}
+}
+
+/**
+ * Checks that a section of rows x cols values, each size bytes, starts
+ * on a section boundary after the header and ends inside the file.
+ * Written so that no amount of garbage in the header can overflow.
+ */
+static bool sectionFits(uint64_t offset, uint64_t rows, uint64_t cols,
+		size_t size, uint64_t fileSize)
+{
+	if (offset < sizeof(ModelFileHeader) || offset % ModelFileAlignment != 0
+			|| offset > fileSize)
+	{
+		return false;
+	}
+	const auto room = (fileSize - offset) / size;
+	return rows == 0 || cols <= room / rows;
+}
+
+/**
+ * Checks that a flattened tree can be walked without leaving the file:
+ * every node's slots are in the child table, and every child is a node
+ * further on (so there are no loops). Threshold nodes need a threshold
+ * and both of their children.
+ */
+static bool isTreeUsable(const ModelFileHeader& header, const char* contents)
+{
+	const auto* nodes = reinterpret_cast<const FlatTreeNode*>(
+			contents + header.nodesOffset);
+	const auto* childTable = reinterpret_cast<const uint32_t*>(
+			contents + header.childTableOffset);
+
+	for (uint64_t i = 0; i < header.numNodes; ++i)
+	{
+		const auto& node = nodes[i];
+		const uint64_t numSlots = node.numValues == ThresholdNode
+				? 2 : node.numValues;
+		if (node.children + numSlots > header.numChildren
+				|| (node.numValues == ThresholdNode
+						&& header.numThresholds == 0))
+		{
+			return false;
+		}
+
+		for (uint64_t slot = 0; slot < numSlots; ++slot)
+		{
+			const auto child = childTable[node.children + slot];
+			if (child == NoChild)
+			{
+				if (node.numValues == ThresholdNode)
+				{
+					return false;
+				}
+			}
+			else if (child <= i || child >= header.numNodes)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * Checks that every class of a Bayes model has a shape we know, and that
+ * all of their whitenings fit in the rest of the file.
+ */
+static bool isBayesUsable(const ModelFileHeader& header,
+		const char* contents)
+{
+	const auto* shapes = reinterpret_cast<const uint32_t*>(
+			contents + header.shapesOffset);
+	const auto room = (header.fileSize - header.whiteningsOffset)
+			/ sizeof(Decimal);
+
+	// numFields fits in the means section, so numFields * numFields
+	// only can't overflow once it fits in room
+	uint64_t used = 0;
+	for (uint64_t c = 0; c < header.numClasses; ++c)
+	{
+		if (shapes[c] > static_cast<uint32_t>(GaussianModel::Shape::IDENTITY))
+		{
+			return false;
+		}
+		const auto shape = static_cast<GaussianModel::Shape>(shapes[c]);
+		if ((shape == GaussianModel::Shape::FULL
+					|| shape == GaussianModel::Shape::SINGULAR)
+				&& header.numFields > room / header.numFields)
+		{
+			return false;
+		}
+
+		const auto size = whiteningSize(shape, header.numFields);
+		if (size > room - used)
+		{
+			return false;
+		}
+		used += size;
+	}
+	return true;
+}
+
+/**
+ * Checks that a file is a model we can use: the right format, written
+ * with the same Decimal width we were built with, and with every section
+ * inside the file. Nothing in a file that passes can send a loaded
+ * model outside of it.
+ */
+static bool isUsable(const MappedFile& file)
+{
+	ModelFileHeader header;
+	if (file.size() < sizeof(header))
+	{
+		return false;
+	}
+	std::memcpy(&header, file.begin(), sizeof(header));
+
+	if (std::memcmp(header.magic, ModelFileMagic, sizeof(header.magic)) != 0
+			|| header.version != ModelFileVersion
+			|| header.decimalSize != sizeof(Decimal)
+			|| header.fileSize != file.size())
+	{
+		return false;
+	}
+
+	const auto fileSize = header.fileSize;
+	if (header.kind == ModelKind::BAYES)
+	{
+		// Types are a byte, starting at 1
+		return header.numFields > 0
+			&& header.numClasses > 0 && header.numClasses < NoType
+			&& sectionFits(header.meansOffset, header.numFields,
+					header.numClasses, sizeof(Decimal), fileSize)
+			&& sectionFits(header.shapesOffset, 1, header.numClasses,
+					sizeof(uint32_t), fileSize)
+			&& sectionFits(header.whiteningsOffset, 0, 0, sizeof(Decimal),
+					fileSize)
+			&& sectionFits(header.logDeterminantsOffset, 1,
+					header.numClasses, sizeof(Decimal), fileSize)
+			&& isBayesUsable(header, file.begin());
+	}
+	else if (header.kind == ModelKind::DECISION_TREE)
+	{
+		return header.numNodes > 0 && header.numNodes < NoChild
+			&& sectionFits(header.nodesOffset, 1, header.numNodes,
+					sizeof(FlatTreeNode), fileSize)
+			&& sectionFits(header.childTableOffset, 1, header.numChildren,
+					sizeof(uint32_t), fileSize)
+			&& (header.numThresholds == 0
+					|| (header.numThresholds == header.numNodes
+						&& sectionFits(header.thresholdsOffset, 1,
+								header.numThresholds, sizeof(Decimal),
+								fileSize)))
+			&& isTreeUsable(header, file.begin());
+	}
+	return false;
+}
+
+bool isModelFileReadable(std::string filename)
+{
+	try
+	{
+		MappedFile file{filename};
+		return isUsable(file);
+	}
+	catch (const std::runtime_error&)
+	{
+		return false; // Can't even open it
+	}
+}
+
+/**
+ * A Bayes classifier that scores points with the means, whitenings and
+ * log determinants in a mapped model file.
+ */
+class MappedBayesClassifier : public Classifier
+{
+public:
+	explicit MappedBayesClassifier(std::shared_ptr<const MappedFile> file,
+			const ModelFileHeader& header);
+	using Classifier::classify;
+	uint8_t classify(const PointRef& point) const override;
+	uint8_t classify(const PointRef& point,
+			ClassifierWorkspace& workspace) const override;
+
+private:
+	std::shared_ptr<const MappedFile> file;
+	DataMap means;
+	const uint32_t* shapes;
+	std::vector<const Decimal*> whitenings; // Where each class's starts
+	Eigen::Map<const ColVector> logDeterminants;
+};
+
+MappedBayesClassifier::MappedBayesClassifier(
+		std::shared_ptr<const MappedFile> file, const ModelFileHeader& header)
+: file{std::move(file)},
+  means{reinterpret_cast<const Decimal*>(
+		  this->file->begin() + header.meansOffset),
+	  static_cast<Eigen::Index>(header.numFields),
+	  static_cast<Eigen::Index>(header.numClasses)},
+  shapes{reinterpret_cast<const uint32_t*>(
+		  this->file->begin() + header.shapesOffset)},
+  whitenings{},
+  logDeterminants{reinterpret_cast<const Decimal*>(
+		  this->file->begin() + header.logDeterminantsOffset),
+	  static_cast<Eigen::Index>(header.numClasses)}
+{
+	auto whitening = reinterpret_cast<const Decimal*>(
+			this->file->begin() + header.whiteningsOffset);
+	for (auto c = 0; c < header.numClasses; ++c)
+	{
+		whitenings.push_back(whitening);
+		whitening += whiteningSize(
+				static_cast<GaussianModel::Shape>(shapes[c]),
+				header.numFields);
+	}
+}
+
+uint8_t MappedBayesClassifier::classify(const PointRef& point) const
+{
+	ClassifierWorkspace workspace{};
+	return classify(point, workspace);
+}
+
+/**
+ * Same scores as BayesClassifier::getScores. Distances are worked out
+ * the same way GaussianModel::distance does for each shape, with full
+ * ones as |W * (x - mean)'|^2.
+ */
+uint8_t MappedBayesClassifier::classify(const PointRef& point,
+		ClassifierWorkspace& workspace) const
+{
+	assert(point.cols() == means.rows());
+
+	const auto numFields = means.rows();
+	workspace.scores.resize(means.cols());
+	for (auto c = 0; c < means.cols(); ++c)
+	{
+		workspace.offset = point.transpose() - means.col(c);
+
+		Decimal distance;
+		switch (static_cast<GaussianModel::Shape>(shapes[c]))
+		{
+		case GaussianModel::Shape::IDENTITY:
+			distance = workspace.offset.squaredNorm();
+			break;
+		case GaussianModel::Shape::DIAGONAL:
+		{
+			Eigen::Map<const ColVector> inverseVariances{whitenings[c],
+				numFields};
+			distance = (workspace.offset.array().square()
+					* inverseVariances.array()).sum();
+			break;
+		}
+		default:
+		{
+			DataMap whitening{whitenings[c], numFields, numFields};
+			distance = whitening.lazyProduct(workspace.offset).squaredNorm();
+			break;
+		}
+		}
+		workspace.scores[c] = -logDeterminants[c] - distance;
+	}
+
+	// Types start at index 1, but vectors at index 0
+	Eigen::Index best;
+	workspace.scores.maxCoeff(&best);
+	return best + 1;
+}
+
+/**
+ * A decision tree that classifies straight from the flattened nodes
+ * in a mapped model file.
+ */
+class MappedDecisionTree : public Classifier
+{
+public:
+	explicit MappedDecisionTree(std::shared_ptr<const MappedFile> file,
+			const ModelFileHeader& header);
+	using Classifier::classify;
+	uint8_t classify(const PointRef& point) const override;
+
+private:
+	std::shared_ptr<const MappedFile> file;
+	const FlatTreeNode* nodes;
+	const uint32_t* childTable;
+	const Decimal* thresholds;
+};
+
+MappedDecisionTree::MappedDecisionTree(
+		std::shared_ptr<const MappedFile> file, const ModelFileHeader& header)
+: file{std::move(file)},
+  nodes{reinterpret_cast<const FlatTreeNode*>(
+		  this->file->begin() + header.nodesOffset)},
+  childTable{reinterpret_cast<const uint32_t*>(
+		  this->file->begin() + header.childTableOffset)},
+  thresholds{header.numThresholds == 0 ? nullptr
+		  : reinterpret_cast<const Decimal*>(
+				  this->file->begin() + header.thresholdsOffset)}
+{
+	assert(header.numNodes > 0);
+}
+
+uint8_t MappedDecisionTree::classify(const PointRef& point) const
+{
+	return classifyFlat(nodes, childTable, thresholds, point);
+}
+
+/**
+ * Loads a model saved by saveModel. The file is memory-mapped and
+ * classified with in place, so this takes about as long as opening it.
+ * Files that aren't models we can use (see isModelFileReadable) throw
+ * std::runtime_error.
+ */
+std::shared_ptr<Classifier> loadModel(std::string filename)
+{
+	auto file = std::make_shared<const MappedFile>(filename);
+	if (!isUsable(*file))
+	{
+		throw std::runtime_error{filename
+			+ " isn't a model file this build can read"};
+	}
+
+	ModelFileHeader header;
+	std::memcpy(&header, file->begin(), sizeof(header));
+
+	if (header.kind == ModelKind::BAYES)
+	{
+		return std::make_shared<MappedBayesClassifier>(std::move(file),
+				header);
+	}
+	else
+	{
+		return std::make_shared<MappedDecisionTree>(std::move(file), header);
+	}
+}
@@ -0,0 +1,86 @@
+/*
+ * ModelFile.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#ifndef MODELFILE_H_
+#define MODELFILE_H_
+
+#include "Classifier.h"
+#include "Types.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * Model files hold a trained classifier, laid out so that loading one
+ * is just memory-mapping it: the loaded classifier works straight from
+ * the mapping, without parsing or copying anything.
+ *
+ * A Bayes classifier is saved as
+ *
+ *   header          ModelFileHeader
+ *   means           numFields x numClasses Decimals, one class per column
+ *   shapes          numClasses GaussianModel::Shapes, as uint32_t
+ *   whitenings      each class's in turn, depending on its shape: a
+ *                   numFields x numFields Decimal matrix, column-major,
+ *                   for full and singular models (see
+ *                   GaussianModel::getWhitening), numFields inverse
+ *                   variances for diagonal ones, and nothing for the
+ *                   identity
+ *   logDeterminants numClasses Decimals
+ *
+ * and a decision tree as
+ *
+ *   header          ModelFileHeader
+ *   nodes           numNodes FlatTreeNodes
+ *   childTable      numChildren uint32_t node indices
+ *   thresholds      numThresholds Decimals, either none or one per node
+ *
+ * Offsets of the sections a model doesn't have are left at 0. Every
+ * section starts on a ModelFileAlignment boundary. Like binary
+ * datasets, files are written in the byte order and Decimal width of
+ * the machine writing them, and can only be read back on a matching
+ * machine.
+ *
+ * loadModel checks every section of a file before using it, and throws
+ * std::runtime_error for anything it can't use.
+ */
+constexpr uint32_t ModelFileVersion = 3;
+constexpr size_t ModelFileAlignment = 64;
+
+enum class ModelKind : uint32_t
+{
+	BAYES,
+	DECISION_TREE
+};
+
+struct ModelFileHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t decimalSize;
+	ModelKind kind;
+	uint32_t padding;
+	uint64_t numFields;
+	uint64_t numClasses;
+	uint64_t meansOffset;
+	uint64_t shapesOffset;
+	uint64_t whiteningsOffset;
+	uint64_t logDeterminantsOffset;
+	uint64_t numNodes;
+	uint64_t numChildren;
+	uint64_t nodesOffset;
+	uint64_t childTableOffset;
+	uint64_t numThresholds;
+	uint64_t thresholdsOffset;
+	uint64_t fileSize;
+};
+
+void saveModel(const Classifier& classifier, std::string filename);
+std::shared_ptr<Classifier> loadModel(std::string filename);
+bool isModelFileReadable(std::string filename);
+
+#endif /* MODELFILE_H_ */
@@ -17,15 +17,15 @@ template <typename T>
 struct Partition
 {
 public:
-	Partition(const T& training, const T& testing);
+	Partition(T training, T testing);
 	T training;
 	T testing;
 };
 
 template <typename T>
-Partition<T>::Partition(const T& training, const T& testing)
-: training{training},
-  testing{testing}
+Partition<T>::Partition(T training, T testing)
+: training{std::move(training)},
+  testing{std::move(testing)}
 {
 }
 
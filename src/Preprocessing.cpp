@@ -0,0 +1,135 @@
+/*
+ * Preprocessing.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#include "Preprocessing.h"
+#include "ClassStatistics.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+// How many rows to discretize before adding them to the covariance
+constexpr Eigen::Index PreprocessingBlockSize = 256;
+
+/**
+ * Works out the boundaries between bins for one column of data. Bin i
+ * holds the values in [edges[i], edges[i+1]), except the last bin, which
+ * also holds the largest value.
+ */
+static std::vector<Accumulator> binEdges(ColVector column, size_t numBins,
+		BinningMethod method)
+{
+	assert(column.rows() > 0);
+	std::vector<Accumulator> edges(numBins + 1);
+
+	if (method == BinningMethod::EQUAL_WIDTH)
+	{
+		// Done in double precision like R does it, so that points right
+		// on an edge end up in the same bin
+		const auto min = static_cast<double>(column.minCoeff());
+		const auto width = (static_cast<double>(column.maxCoeff()) - min)
+				/ numBins;
+		for (auto i = 0; i <= numBins; ++i)
+		{
+			edges[i] = min + i * width;
+		}
+	}
+	else
+	{
+		assert(method == BinningMethod::EQUAL_FREQUENCY);
+
+		// Edges are quantiles of the column, interpolated between the
+		// nearest points the same way R's quantile() does by default
+		std::sort(column.data(), column.data() + column.rows());
+		for (auto i = 0; i <= numBins; ++i)
+		{
+			auto position = static_cast<Accumulator>(column.rows() - 1) * i
+					/ numBins;
+			auto below = static_cast<Eigen::Index>(std::floor(position));
+			auto above = std::min<Eigen::Index>(below + 1, column.rows() - 1);
+			const auto low = static_cast<Accumulator>(column[below]);
+			const auto high = static_cast<Accumulator>(column[above]);
+			edges[i] = low + (position - below) * (high - low);
+		}
+	}
+
+	return edges;
+}
+
+/**
+ * Gives the category of a value. Categories start at 1.
+ */
+static Decimal binOf(Accumulator value,
+		const std::vector<Accumulator>& edges)
+{
+	const auto numBins = edges.size() - 1;
+	for (auto i = 0; i < numBins - 1; ++i)
+	{
+		if (value < edges[i + 1])
+		{
+			return i + 1;
+		}
+	}
+	return numBins;
+}
+
+/**
+ * Sorts the values in each of the selected columns into numBins
+ * categories, numbered from 1. The other columns are left alone.
+ *
+ * This replaces running arules' discretize() over the data in R.
+ * EQUAL_WIDTH gives the same categories as its "interval" method, and
+ * EQUAL_FREQUENCY the same as its "frequency" method.
+ *
+ * The covariance of the result is worked out as each block of rows is
+ * discretized, so we don't need a second pass over the data for it.
+ */
+PreprocessedDataset discretize(const Dataset& dataset,
+		const std::vector<size_t>& columns,
+		size_t numBins,
+		BinningMethod method)
+{
+	assert(numBins > 0);
+
+	const auto& data = dataset.getData();
+	std::vector<std::vector<Accumulator>> edges{};
+	edges.reserve(columns.size());
+	for (auto column : columns)
+	{
+		assert(column < dataset.NumFields);
+		edges.push_back(binEdges(data.col(column), numBins, method));
+	}
+
+	DataMatrix discrete = data;
+	const TypeVector oneClass = TypeVector::Ones(data.rows());
+	ClassStatistics stats{dataset.NumFields, 1};
+
+	for (Eigen::Index start = 0; start < data.rows();
+			start += PreprocessingBlockSize)
+	{
+		const auto blockSize = std::min(PreprocessingBlockSize,
+				data.rows() - start);
+
+		for (auto c = 0; c < columns.size(); ++c)
+		{
+			for (auto i = start; i < start + blockSize; ++i)
+			{
+				discrete(i, columns[c]) = binOf(discrete(i, columns[c]),
+						edges[c]);
+			}
+		}
+
+		stats.add(discrete.middleRows(start, blockSize),
+				oneClass.segment(start, blockSize));
+	}
+
+	auto covariance = stats.getCovarianceMatrix(1, ClassifierType::OPTIMAL);
+
+	return PreprocessedDataset{
+		Dataset{dataset.getNames(), dataset.getTypes(),
+			std::move(discrete), dataset.NumClasses},
+		std::move(covariance)};
+}
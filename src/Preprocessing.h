@@ -0,0 +1,37 @@
+/*
+ * Preprocessing.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#ifndef PREPROCESSING_H_
+#define PREPROCESSING_H_
+
+#include "Dataset.h"
+#include "Types.h"
+#include <cstdint>
+#include <vector>
+
+enum class BinningMethod : uint8_t
+{
+	EQUAL_WIDTH,    // Every bin covers the same range of values
+	EQUAL_FREQUENCY // Every bin holds about the same number of points
+};
+
+/**
+ * A dataset after preprocessing, along with the covariance matrix of all
+ * its fields.
+ */
+struct PreprocessedDataset
+{
+	Dataset dataset;
+	CovarianceMatrix covariance;
+};
+
+PreprocessedDataset discretize(const Dataset& dataset,
+		const std::vector<size_t>& columns,
+		size_t numBins,
+		BinningMethod method);
+
+#endif /* PREPROCESSING_H_ */
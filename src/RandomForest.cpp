@@ -0,0 +1,221 @@
+/*
+ * RandomForest.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#include "RandomForest.h"
+#include "Dataset.h"
+#include "DatasetView.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <random>
+
+// How many points and trees classifyBatch works on at a time: a block
+// of points is small enough to stay in cache along with the nodes of a
+// block of trees
+constexpr Eigen::Index ForestPointBlockSize = 256;
+constexpr size_t ForestTreeBlockSize = 8;
+
+RandomForest::RandomForest(const TypeRef& types, const DataRef& data,
+		size_t numTrees, unsigned int numThreads, uint64_t seed)
+: NumTrees{numTrees},
+  trees{},
+  numVoteTypes{0}
+{
+	std::vector<size_t> rows(types.rows());
+	for (auto i = 0; i < rows.size(); ++i)
+	{
+		rows[i] = i;
+	}
+	train(types, data, rows, numThreads, seed);
+}
+
+/**
+ * Trains a forest on the rows in a view, without copying them.
+ */
+RandomForest::RandomForest(const DatasetView& view, size_t numTrees,
+		unsigned int numThreads, uint64_t seed)
+: NumTrees{numTrees},
+  trees{},
+  numVoteTypes{0}
+{
+	const auto& dataset = view.getDataset();
+	train(dataset.getTypes(), dataset.getData(), view.getRowIndices(),
+			numThreads, seed);
+}
+
+/**
+ * Trains every tree on its own bootstrap sample of the rows. Each node
+ * picks from the square root of the number of columns, the usual
+ * choice for classification.
+ */
+void RandomForest::train(const TypeRef& types, const DataRef& data,
+		const std::vector<size_t>& rows, unsigned int numThreads,
+		uint64_t seed)
+{
+	assert(NumTrees > 0);
+	assert(rows.size() > 0);
+
+	numVoteTypes = static_cast<size_t>(types.maxCoeff()) + 1;
+	const auto attributesPerNode = std::max<size_t>(1,
+			std::lround(std::sqrt(data.cols())));
+
+	// Every tree's seed is picked before any of them are trained, so it
+	// doesn't matter what order they're trained in
+	std::mt19937_64 random{seed};
+	std::vector<uint64_t> seeds(NumTrees);
+	for (auto& treeSeed : seeds)
+	{
+		treeSeed = random();
+	}
+
+	// The rows are only sorted by each column once, for the whole forest
+	std::vector<std::vector<size_t>> columnOrders(data.cols(), rows);
+	for (auto j = 0; j < data.cols(); ++j)
+	{
+		std::stable_sort(begin(columnOrders[j]), end(columnOrders[j]),
+				[&data, j](size_t a, size_t b)
+				{
+					return data(a, j) < data(b, j);
+				});
+	}
+
+	auto trainTree = [&](size_t i)
+	{
+		// Count how many times each row is picked for the sample, then
+		// read the sample off in each column's order
+		std::mt19937_64 treeRandom{seeds[i]};
+		std::vector<uint32_t> timesPicked(data.rows(), 0);
+		for (auto j = 0; j < rows.size(); ++j)
+		{
+			++timesPicked[rows[treeRandom() % rows.size()]];
+		}
+
+		std::vector<std::vector<size_t>> sample(data.cols());
+		for (auto j = 0; j < data.cols(); ++j)
+		{
+			sample[j].reserve(rows.size());
+			for (auto row : columnOrders[j])
+			{
+				sample[j].insert(end(sample[j]), timesPicked[row], row);
+			}
+		}
+
+		trees[i].reset(new DecisionTree{types, data, std::move(sample),
+			attributesPerNode, treeRandom()});
+	};
+
+	trees.resize(NumTrees);
+	if (numThreads <= 1)
+	{
+		for (auto i = 0; i < NumTrees; ++i)
+		{
+			trainTree(i);
+		}
+		return;
+	}
+
+	WorkStealingPool pool{numThreads};
+	pool.run([&](size_t worker)
+	{
+		std::atomic<size_t> pending{NumTrees};
+		for (size_t i = 0; i < NumTrees; ++i)
+		{
+			pool.spawn(worker, [&trainTree, &pending, i](size_t)
+			{
+				trainTree(i);
+				--pending;
+			});
+		}
+		pool.waitFor(worker, pending);
+	});
+}
+
+/**
+ * Asks every tree what type the point is, and gives the most popular
+ * answer.
+ */
+uint8_t RandomForest::classify(const PointRef& point) const
+{
+	std::array<uint32_t, NoType + 1> votes{};
+	for (const auto& tree : trees)
+	{
+		++votes[tree->classify(point)];
+	}
+	return mostVotes(votes.data());
+}
+
+/**
+ * Classifies every row of points, the same as classify would.
+ *
+ * Each block of points is copied so each point's values are next to
+ * each other, then classified by a block of trees at a time, with the
+ * votes for point i kept at votes[i * numVoteTypes + type].
+ */
+TypeVector RandomForest::classifyBatch(const DataRef& points) const
+{
+	TypeVector types(points.rows());
+	Eigen::Matrix<Decimal, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+		block{};
+	std::vector<uint32_t> votes(ForestPointBlockSize * numVoteTypes);
+
+	for (Eigen::Index start = 0; start < points.rows();
+			start += ForestPointBlockSize)
+	{
+		const auto blockSize = std::min(ForestPointBlockSize,
+				points.rows() - start);
+		block = points.middleRows(start, blockSize);
+		std::fill(begin(votes), end(votes), 0);
+
+		for (size_t firstTree = 0; firstTree < NumTrees;
+				firstTree += ForestTreeBlockSize)
+		{
+			const auto lastTree = std::min(firstTree + ForestTreeBlockSize,
+					NumTrees);
+			for (auto i = 0; i < blockSize; ++i)
+			{
+				const PointRef point = block.row(i);
+				auto* pointVotes = votes.data() + i * numVoteTypes;
+				for (auto t = firstTree; t < lastTree; ++t)
+				{
+					const auto& flat = trees[t]->getFlatTree();
+					const auto type = classifyFlat(flat.nodes.data(),
+							flat.childTable.data(), flat.thresholds.data(),
+							point);
+					assert(type < numVoteTypes);
+					++pointVotes[type];
+				}
+			}
+		}
+
+		for (auto i = 0; i < blockSize; ++i)
+		{
+			types[start + i] = mostVotes(votes.data() + i * numVoteTypes);
+		}
+	}
+
+	return types;
+}
+
+/**
+ * One of the trees in the forest.
+ */
+const DecisionTree& RandomForest::getTree(size_t i) const
+{
+	assert(i < NumTrees);
+	return *trees[i];
+}
+
+/**
+ * The type with the most votes. Ties go to the smallest type.
+ */
+uint8_t RandomForest::mostVotes(const uint32_t* votes) const
+{
+	return std::max_element(votes, votes + numVoteTypes) - votes;
+}
@@ -0,0 +1,63 @@
+/*
+ * RandomForest.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#ifndef RANDOMFOREST_H_
+#define RANDOMFOREST_H_
+
+#include "Classifier.h"
+#include "DecisionTree.h"
+#include "Types.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+class DatasetView;
+
+constexpr size_t DefaultForestSize = 100;
+
+/**
+ * A random forest: lots of decision trees that split on thresholds,
+ * each trained on a bootstrap sample of the rows (as many rows as there
+ * are, picked with replacement) and only allowed to pick from a few
+ * random columns at each node. The trees vote, and the type with the
+ * most votes wins, ties going to the smallest type.
+ *
+ * Trees are trained in parallel, one per task. Each tree gets its own
+ * seed up front, so the forest comes out the same however many threads
+ * there are.
+ *
+ * classifyBatch works through the points a block at a time, running a
+ * few trees at a time over the whole block so their nodes stay in cache,
+ * and adds up the votes in one flat array.
+ */
+class RandomForest : public Classifier
+{
+public:
+	const size_t NumTrees;
+
+public:
+	explicit RandomForest(const TypeRef& types, const DataRef& data,
+			size_t numTrees = DefaultForestSize,
+			unsigned int numThreads = 1, uint64_t seed = 0);
+	explicit RandomForest(const DatasetView& view,
+			size_t numTrees = DefaultForestSize,
+			unsigned int numThreads = 1, uint64_t seed = 0);
+	using Classifier::classify;
+	uint8_t classify(const PointRef& point) const override;
+	TypeVector classifyBatch(const DataRef& points) const override;
+	const DecisionTree& getTree(size_t i) const;
+
+private:
+	void train(const TypeRef& types, const DataRef& data,
+			const std::vector<size_t>& rows, unsigned int numThreads,
+			uint64_t seed);
+	uint8_t mostVotes(const uint32_t* votes) const;
+
+	std::vector<std::unique_ptr<DecisionTree>> trees;
+	size_t numVoteTypes; // Big enough for every type the trees can give
+};
+
+#endif /* RANDOMFOREST_H_ */
@@ -9,24 +9,60 @@
 #define TYPES_H_
 
 #include <cstdint>
+#include <type_traits>
 #include <eigen3/Eigen/Dense>
 
-using Decimal = long double;
+// The precision everything is stored and worked out in. Build with
+// -DCLASSIFIER_DECIMAL=float (or double) to trade accuracy for speed:
+// Eigen can't vectorize long doubles at all, and floats fit twice as
+// many numbers into each SIMD register as doubles do.
+#ifndef CLASSIFIER_DECIMAL
+#define CLASSIFIER_DECIMAL long double
+#endif
+
+using Decimal = CLASSIFIER_DECIMAL;
+
+// Sums over lots of points lose too much precision in float, so running
+// totals like means and scatter matrices are always at least doubles
+using Accumulator = std::conditional<(sizeof(Decimal) < sizeof(double)),
+	double, Decimal>::type;
+using AccumulatorVector = Eigen::Matrix<Accumulator, 1, Eigen::Dynamic>;
+using AccumulatorMatrix =
+	Eigen::Matrix<Accumulator, Eigen::Dynamic, Eigen::Dynamic>;
+
 using RowVector = Eigen::Matrix<Decimal, 1, Eigen::Dynamic>;
 using CovarianceMatrix =
 	Eigen::Matrix<Decimal, Eigen::Dynamic, Eigen::Dynamic>;
+using DiagonalMatrix = Eigen::DiagonalMatrix<Decimal, Eigen::Dynamic>;
 using TypeVector = Eigen::Matrix<uint8_t, Eigen::Dynamic, 1>;
 using ColVector = Eigen::Matrix<Decimal, Eigen::Dynamic, 1>;
 using DataMatrix = Eigen::Matrix<Decimal, Eigen::Dynamic, Eigen::Dynamic>;
+using TypeMap = Eigen::Map<const TypeVector>;
+using DataMap = Eigen::Map<const DataMatrix>;
+using TypeRef = Eigen::Ref<const TypeVector>;
+using DataRef = Eigen::Ref<const DataMatrix>;
+
+// A point anywhere in memory, like a row of a DataMatrix, without copying
+using PointRef = Eigen::Ref<const RowVector, 0, Eigen::InnerStride<>>;
 
 enum class ClassifierType : uint8_t
 {
 	OPTIMAL,
 	NAIVE,
 	LINEAR,
-	DECISION_TREE
+	DECISION_TREE,
+	THRESHOLD_TREE,
+	RANDOM_FOREST
 };
 
+// Whether a type of classifier is one of the Bayes classifiers, which
+// are all worked out from the same statistics of each class
+constexpr bool isBayes(ClassifierType type)
+{
+	return type == ClassifierType::OPTIMAL || type == ClassifierType::NAIVE
+		|| type == ClassifierType::LINEAR;
+}
+
 constexpr auto WineFields = 13;
 constexpr auto WineClasses = 3;
 constexpr auto IrisFields = 4;
@@ -0,0 +1,145 @@
+/*
+ * WorkStealingPool.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#include "WorkStealingPool.h"
+#include <cassert>
+#include <thread>
+
+WorkStealingPool::WorkStealingPool(size_t numWorkers)
+: NumWorkers{numWorkers},
+  queues(numWorkers),
+  outstanding{0},
+  queued{0}
+{
+	assert(numWorkers > 0);
+}
+
+/**
+ * Runs a task and everything it spawns, and returns once they've all
+ * finished. The calling thread is worker 0, and the rest of the workers
+ * only exist for as long as this takes.
+ */
+void WorkStealingPool::run(Task task)
+{
+	assert(outstanding == 0);
+	spawn(0, std::move(task));
+
+	std::vector<std::thread> workers{};
+	workers.reserve(NumWorkers - 1);
+	for (auto worker = 1; worker < NumWorkers; ++worker)
+	{
+		workers.emplace_back([this, worker]() { work(worker); });
+	}
+	work(0);
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+/**
+ * Queues up a task to run later. worker is the worker doing the
+ * spawning, and it'll be the first to get a chance at the task.
+ */
+void WorkStealingPool::spawn(size_t worker, Task task)
+{
+	assert(worker < NumWorkers);
+	++outstanding;
+	{
+		std::lock_guard<std::mutex> lock{queues[worker].mutex};
+		queues[worker].tasks.push_back(std::move(task));
+	}
+
+	// Taking the lock makes sure a worker that's about to go to sleep
+	// either sees the task or gets woken up
+	++queued;
+	{
+		std::lock_guard<std::mutex> lock{sleepMutex};
+	}
+	wakeUp.notify_one();
+}
+
+/**
+ * Waits until pending drops to 0, running other tasks in the meantime
+ * so the worker isn't wasted, and so tasks can wait for tasks they
+ * spawned without deadlocking.
+ */
+void WorkStealingPool::waitFor(size_t worker,
+		const std::atomic<size_t>& pending)
+{
+	while (pending > 0)
+	{
+		if (!runOne(worker))
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+/**
+ * Runs one task, the worker's own newest one if it has any or else the
+ * oldest one it can steal. Returns false if every queue was empty.
+ */
+bool WorkStealingPool::runOne(size_t worker)
+{
+	Task task{};
+	for (auto i = 0; i < NumWorkers && !task; ++i)
+	{
+		auto& queue = queues[(worker + i) % NumWorkers];
+		std::lock_guard<std::mutex> lock{queue.mutex};
+		if (queue.tasks.empty())
+		{
+			continue;
+		}
+
+		if (i == 0)
+		{
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+		}
+		else
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+	}
+	if (!task)
+	{
+		return false;
+	}
+
+	--queued;
+	task(worker);
+
+	if (--outstanding == 0)
+	{
+		std::lock_guard<std::mutex> lock{sleepMutex};
+		wakeUp.notify_all();
+	}
+	return true;
+}
+
+/**
+ * Keeps a worker running tasks until there are none left anywhere.
+ */
+void WorkStealingPool::work(size_t worker)
+{
+	while (true)
+	{
+		if (runOne(worker))
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock{sleepMutex};
+		wakeUp.wait(lock, [this]() { return queued > 0 || outstanding == 0; });
+		if (outstanding == 0)
+		{
+			return;
+		}
+	}
+}
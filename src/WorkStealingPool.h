@@ -0,0 +1,67 @@
+/*
+ * WorkStealingPool.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: derek
+ */
+
+#ifndef WORKSTEALINGPOOL_H_
+#define WORKSTEALINGPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/**
+ * Runs a task, and every task it spawns, on a set of worker threads.
+ *
+ * Each worker keeps its own queue of tasks. It takes the newest task
+ * off the back of its own queue, so it keeps working on whatever it
+ * spawned last while that's still in cache. When its queue runs dry it
+ * steals the oldest task off the front of another worker's, which for
+ * recursive work like building a tree is usually the biggest one left.
+ *
+ * Tasks are told which worker is running them, so they can keep
+ * per-worker scratch space, and have to pass that on to spawn and
+ * waitFor.
+ */
+class WorkStealingPool
+{
+public:
+	using Task = std::function<void(size_t worker)>;
+
+	const size_t NumWorkers;
+
+public:
+	explicit WorkStealingPool(size_t numWorkers);
+	void run(Task task);
+	void spawn(size_t worker, Task task);
+	void waitFor(size_t worker, const std::atomic<size_t>& pending);
+
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	bool runOne(size_t worker);
+	void work(size_t worker);
+
+	std::vector<Queue> queues;
+
+	// Tasks that have been spawned but haven't finished, and tasks that
+	// are sitting in a queue
+	std::atomic<size_t> outstanding;
+	std::atomic<size_t> queued;
+
+	// Idle workers sleep on this until there's something to steal
+	std::mutex sleepMutex;
+	std::condition_variable wakeUp;
+};
+
+#endif /* WORKSTEALINGPOOL_H_ */
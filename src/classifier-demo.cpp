@@ -2,60 +2,114 @@
 #include <fstream>
 #include <string>
 #include <array>
+#include <algorithm>
+#include <thread>
+#include <memory>
 #include "BayesClassifier.h"
+#include "BayesFolds.h"
+#include "CascadeClassifier.h"
+#include "FixedBayesClassifier.h"
 #include "DecisionTree.h"
 #include "Partition.h"
 #include "Dataset.h"
+#include "DatasetView.h"
 #include "Types.h"
 #include "CsvReader.h"
+#include "BinaryDataset.h"
+#include "Preprocessing.h"
+#include <sys/stat.h>
 
-void classifyAndTest(const Dataset& data,
+void classifyAndTest(const DatasetView& data,
 		unsigned int numFolds,
 		ClassifierType ctype,
 		int verbosity,
 		std::ostream& resultsOut,
 		std::string modelOutName,
-		std::ostream& finalResults);
+		std::ostream& finalResults,
+		unsigned int numThreads);
+void testCascade(const DatasetView& data,
+		unsigned int numFolds,
+		Decimal threshold,
+		std::ostream& resultsOut);
+Dataset readCachedDataset(std::string csvName,
+		Dataset (*csvReader)(std::string, unsigned int),
+		unsigned int numThreads);
+
+// How sure naive Bayes has to be before the cascade trusts it
+constexpr Decimal CascadeThreshold = 4;
 
 int main(int argc, char** argv)
 {
-	auto verbosity = argc - 1;
+	// Usage: classifier [-j threads] [args...]
+	// "-j" sets how many threads read the data files and train the
+	// trees and forests. Every other argument increases the verbosity.
+	auto verbosity = 0;
+	auto numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	for (auto i = 1; i < argc; ++i)
+	{
+		if (std::string{argv[i]} == "-j" && i + 1 < argc)
+		{
+			numThreads = std::stoul(argv[++i]);
+		}
+		else
+		{
+			++verbosity;
+		}
+	}
 
 	std::array<Dataset, 3> datasets {
-			readIrisDataset("../data/iris.csv"),
-			readHeartDiseaseDataset("../data/heartDisease.csv"),
-			readWineDataset("../data/wine.csv")
+			readCachedDataset("../data/iris.csv",
+					readIrisDataset, numThreads),
+			readCachedDataset("../data/heartDisease.csv",
+					readHeartDiseaseDataset, numThreads),
+			readCachedDataset("../data/wine.csv",
+					readWineDataset, numThreads)
 	};
 
+	// The decision tree needs discrete data, so sort the continuous
+	// columns into 3 categories each
 	std::array<Dataset, 3> discreteDatasets {
-		readIrisDataset("../data/irisDiscrete.csv"),
-		readHeartDiseaseDataset("../data/heartDiseaseDiscrete.csv"),
-		readWineDataset("../data/wineDiscrete.csv")
+		discretize(datasets[0], {0, 1, 2, 3},
+				3, BinningMethod::EQUAL_WIDTH).dataset,
+		discretize(datasets[1], {0, 3, 4, 7, 9},
+				3, BinningMethod::EQUAL_WIDTH).dataset,
+		discretize(datasets[2], {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12},
+				3, BinningMethod::EQUAL_WIDTH).dataset
 	};
 
-	datasets[0].shuffle();
-	datasets[1].shuffle();
-	datasets[2].shuffle();
-	discreteDatasets[0].shuffle();
-	discreteDatasets[1].shuffle();
-	discreteDatasets[2].shuffle();
+	// Shuffle views of the datasets rather than the datasets themselves,
+	// so the ones read from binary files are never copied
+	std::array<DatasetView, 3> shuffledDatasets {
+		DatasetView{datasets[0]}.shuffled(),
+		DatasetView{datasets[1]}.shuffled(),
+		DatasetView{datasets[2]}.shuffled()
+	};
+	std::array<DatasetView, 3> shuffledDiscreteDatasets {
+		DatasetView{discreteDatasets[0]}.shuffled(),
+		DatasetView{discreteDatasets[1]}.shuffled(),
+		DatasetView{discreteDatasets[2]}.shuffled()
+	};
 
 	std::array<std::string, 3> datasetLabels = {
 			"Iris", "Heart Disease", "Wine"
 	};
 
-	std::array<ClassifierType, 4> classifierTypes = {
+	std::array<ClassifierType, 6> classifierTypes = {
 			ClassifierType::OPTIMAL,
 			ClassifierType::NAIVE,
 			ClassifierType::LINEAR,
-			ClassifierType::DECISION_TREE
+			ClassifierType::DECISION_TREE,
+			ClassifierType::THRESHOLD_TREE,
+			ClassifierType::RANDOM_FOREST
 	};
 
-	std::array<std::string, 4> classifierTypeLabels = {
+	std::array<std::string, 6> classifierTypeLabels = {
 			"Optimal Bayes",
 			"Naive Bayes",
 			"Linear Bayes",
-			"Decision Tree"
+			"Decision Tree",
+			"Threshold Tree",
+			"Random Forest"
 	};
 
 	// Open final results CSV in append mode, so that we can build up
@@ -72,7 +126,7 @@ int main(int argc, char** argv)
 	}
 	finalResults << std::endl;
 
-	for (auto classifierNum = 0; classifierNum < 4; ++classifierNum)
+	for (auto classifierNum = 0; classifierNum < 6; ++classifierNum)
 	{
 		// Output row label for final results CSV
 		finalResults << classifierTypeLabels[classifierNum];
@@ -89,8 +143,11 @@ int main(int argc, char** argv)
 				+ "-10fold-results.txt"};
 			assert(resultsFile.is_open());
 			auto modelFileName  = out2name.str() + "-10fold-model";
-			auto& data = classifierNum < 3
-					? datasets[datasetNum] : discreteDatasets[datasetNum];
+			// Only trees that split by value need discretized data
+			auto& data = classifierTypes[classifierNum]
+					== ClassifierType::DECISION_TREE
+					? shuffledDiscreteDatasets[datasetNum]
+					: shuffledDatasets[datasetNum];
 			std::cout << datasetLabels[datasetNum]
 					  << " data using 10-fold cross-validation "
 					  << "(" << classifierTypeLabels[classifierNum]
@@ -98,7 +155,8 @@ int main(int argc, char** argv)
 					  << std::endl << std::endl;
 
 			classifyAndTest(data, 10, classifierTypes[classifierNum],
-					verbosity, resultsFile, modelFileName, finalResults);
+					verbosity, resultsFile, modelFileName, finalResults,
+					numThreads);
 			resultsFile.close();
 
 			// Leave-one-out cross validation
@@ -113,7 +171,7 @@ int main(int argc, char** argv)
 					  << std::endl << std::endl;
 			classifyAndTest(data, datasets[datasetNum].size(),
 					classifierTypes[classifierNum], verbosity,
-					resultsFile, modelFileName, finalResults);
+					resultsFile, modelFileName, finalResults, numThreads);
 			resultsFile.close();
 		}
 
@@ -123,16 +181,74 @@ int main(int argc, char** argv)
 	finalResults << std::endl;
 	finalResults.close();
 
+	// See how much of the time naive Bayes needs optimal Bayes's help
+	auto cascadeResults = std::ofstream{"output/cascadeResults.txt"};
+	assert(cascadeResults.is_open());
+	for (auto datasetNum = 0; datasetNum < 3; ++datasetNum)
+	{
+		std::cout << datasetLabels[datasetNum]
+				  << " data using 10-fold cross-validation "
+				  << "(Naive/Optimal Bayes cascade)"
+				  << std::endl << std::endl;
+		cascadeResults << datasetLabels[datasetNum] << ": ";
+		testCascade(shuffledDatasets[datasetNum], 10, CascadeThreshold,
+				cascadeResults);
+	}
+	cascadeResults.close();
+
 	return 0;
 }
 
-void classifyAndTest(const Dataset& data,
+/**
+ * Cross-validates a cascade that only asks optimal Bayes about the
+ * points naive Bayes isn't sure of, and reports how accurate it was
+ * and how many points it passed on.
+ */
+void testCascade(const DatasetView& data,
+		unsigned int numFolds,
+		Decimal threshold,
+		std::ostream& resultsOut)
+{
+	auto timesRight = 0;
+	auto timesEscalated = 0.0;
+
+	for (auto k = 1; k <= numFolds; ++k)
+	{
+		auto indices = kFoldIndices(k, numFolds, data.size());
+		auto partitions = data.partition(indices.first, indices.second);
+
+		CascadeClassifier cascade{
+			specialize(partitions.training.classifier(ClassifierType::NAIVE)),
+			specialize(partitions.training.classifier(
+					ClassifierType::OPTIMAL)),
+			threshold};
+
+		ClassifierWorkspace workspace{};
+		for (auto i = 0; i < partitions.testing.size(); ++i)
+		{
+			if (cascade.classify(partitions.testing.getPoint(i), workspace)
+					== partitions.testing.getType(i))
+			{
+				++timesRight;
+			}
+		}
+		timesEscalated += cascade.getEscalatedFraction()
+			* partitions.testing.size();
+	}
+
+	resultsOut << "accuracy=" << timesRight / static_cast<double>(data.size())
+			   << ", escalated=" << timesEscalated / data.size()
+			   << std::endl;
+}
+
+void classifyAndTest(const DatasetView& data,
 		unsigned int numFolds,
 		ClassifierType ctype,
 		int verbosity,
 		std::ostream& resultsOut,
 		std::string modelOutName,
-		std::ostream& finalResults)
+		std::ostream& finalResults,
+		unsigned int numThreads)
 {
 	std::vector<unsigned int> timesRight(numFolds, 0);
 	std::vector<unsigned int> timesWrong(numFolds, 0);
@@ -141,6 +257,15 @@ void classifyAndTest(const Dataset& data,
 	auto totalTimesWrong = 0;
 	auto totalTimesUndecided = 0;
 
+	// Bayes classifiers for each fold can be worked out from the
+	// statistics of the whole dataset (the view has all of its rows)
+	std::unique_ptr<BayesFolds> bayesFolds{};
+	if (isBayes(ctype))
+	{
+		assert(data.size() == data.getDataset().size());
+		bayesFolds.reset(new BayesFolds{data.getDataset(), ctype});
+	}
+
 	// Classify and test the data
 	for (auto k = 1; k <= numFolds; ++k)
 	{
@@ -149,10 +274,14 @@ void classifyAndTest(const Dataset& data,
 		auto partitions = data.partition(indices.first, indices.second);
 
 		// Create a classifier for the dataset
-		auto c = partitions.training.classifier(ctype);
+		// Bayes classifiers for the datasets we know the size of can
+		// use fixed-size matrices
+		auto c = bayesFolds
+				? specialize(bayesFolds->classifier(partitions.testing))
+				: partitions.training.classifier(ctype, numThreads);
 
 		// If it's a decision tree, output it
-		if (ctype == ClassifierType::DECISION_TREE)
+		if (auto tree = dynamic_cast<DecisionTree*>(c.get()))
 		{
 			// Although for leave-one-out testing we only print one
 			// tree, since there's ~100 of them and they all look
@@ -163,16 +292,26 @@ void classifyAndTest(const Dataset& data,
 				name << modelOutName << "-" << k << ".dot";
 				auto modelOut = std::ofstream{name.str()};
 				assert(modelOut.is_open());
-				dynamic_cast<DecisionTree*>(c.get())->print(modelOut);
+				tree->print(modelOut);
 				modelOut.close();
+
+				// And as source that can be compiled in
+				std::stringstream sourceName;
+				sourceName << modelOutName << "-" << k << ".h";
+				auto sourceOut = std::ofstream{sourceName.str()};
+				assert(sourceOut.is_open());
+				tree->printSource(sourceOut);
+				sourceOut.close();
 			}
 		}
 
+		// Classify the whole testing set in one block
+		TypeVector decided = c->classifyBatch(partitions.testing.getPoints());
+
 		// Test each point in the testing set
 		for (auto i = 0; i < partitions.testing.size(); ++i)
 		{
-			// Classify
-			auto type = c->classify(partitions.testing.getPoint(i));
+			auto type = decided[i];
 
 			if (type == partitions.testing.getType(i))
 			{
@@ -238,3 +377,31 @@ void classifyAndTest(const Dataset& data,
 	finalResults << "," << accuracy;
 }
 
+
+/**
+ * Reads a dataset from the binary copy kept next to its CSV file, which
+ * is much faster than parsing the CSV. If the binary copy is missing or
+ * older than the CSV, or was written by a build with a different
+ * precision, the CSV is parsed and the binary copy rewritten.
+ */
+Dataset readCachedDataset(std::string csvName,
+		Dataset (*csvReader)(std::string, unsigned int),
+		unsigned int numThreads)
+{
+	auto binaryName = csvName.substr(0, csvName.rfind('.')) + ".bin";
+
+	struct stat csvInfo;
+	struct stat binaryInfo;
+	auto csvExists = stat(csvName.c_str(), &csvInfo) == 0;
+	auto binaryExists = stat(binaryName.c_str(), &binaryInfo) == 0;
+
+	if (binaryExists && (!csvExists || binaryInfo.st_mtime >= csvInfo.st_mtime)
+			&& isBinaryDatasetReadable(binaryName))
+	{
+		return readBinaryDataset(binaryName);
+	}
+
+	auto dataset = csvReader(csvName, numThreads);
+	writeBinaryDataset(dataset, binaryName);
+	return dataset;
+}
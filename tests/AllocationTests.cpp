@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "../src/BayesClassifier.h"
+#include "../src/Classifier.h"
+#include "../src/ContingencyTable.h"
+#include "../src/CsvReader.h"
+#include "../src/Dataset.h"
+#include "../src/FixedBayesClassifier.h"
+#include "../src/Preprocessing.h"
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+// Counts every heap allocation made while counting is on. Replacing
+// malloc catches Eigen's allocations as well as operator new's, which
+// ends up calling malloc too.
+static bool counting = false;
+static size_t allocations = 0;
+
+extern "C" void* __libc_malloc(size_t size);
+
+extern "C" void* malloc(size_t size)
+{
+	if (counting)
+	{
+		++allocations;
+	}
+	return __libc_malloc(size);
+}
+
+// Classifies every point twice, and counts the allocations made the
+// second time, once the workspace has grown to fit
+static size_t countAllocations(const Classifier& classifier,
+		const Dataset& data)
+{
+	ClassifierWorkspace workspace{};
+	uint8_t total = 0;
+	for (auto i = 0; i < data.size(); ++i)
+	{
+		total += classifier.classify(data.getPoint(i), workspace);
+	}
+
+	allocations = 0;
+	counting = true;
+	for (auto i = 0; i < data.size(); ++i)
+	{
+		total += classifier.classify(data.getPoint(i), workspace);
+	}
+	counting = false;
+
+	EXPECT_NE(0, total); // So the loops can't be optimized out
+	return allocations;
+}
+
+TEST(AllocationTests, CountingWorks)
+{
+	allocations = 0;
+	counting = true;
+	auto vector = DataMatrix(10, 10);
+	counting = false;
+	EXPECT_EQ(1, allocations);
+}
+
+TEST(AllocationTests, BayesClassifyDoesNotAllocate)
+{
+	auto data = readHeartDiseaseDataset("../data/heartDisease.csv");
+	for (auto type : {ClassifierType::OPTIMAL, ClassifierType::NAIVE,
+			ClassifierType::LINEAR})
+	{
+		auto classifier = data.classifier(type);
+		EXPECT_EQ(0, countAllocations(*classifier, data));
+	}
+}
+
+TEST(AllocationTests, FixedBayesClassifyDoesNotAllocate)
+{
+	auto data = readIrisDataset("../data/iris.csv");
+	auto classifier = specialize(data.classifier(ClassifierType::OPTIMAL));
+	EXPECT_EQ(0, countAllocations(*classifier, data));
+}
+
+TEST(AllocationTests, DecisionTreeClassifyDoesNotAllocate)
+{
+	auto data = discretize(readIrisDataset("../data/iris.csv"),
+			{0, 1, 2, 3}, 3, BinningMethod::EQUAL_WIDTH).dataset;
+	auto classifier = data.classifier(ClassifierType::DECISION_TREE);
+	EXPECT_EQ(0, countAllocations(*classifier, data));
+}
+
+TEST(AllocationTests, GainDoesNotAllocate)
+{
+	auto data = discretize(readWineDataset("../data/wine.csv"),
+			{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12}, 3,
+			BinningMethod::EQUAL_FREQUENCY).dataset;
+	std::vector<size_t> rows(data.size());
+	std::iota(begin(rows), end(rows), 0);
+	ContingencyTable table{data.size(), data.NumClasses + 1};
+
+	allocations = 0;
+	counting = true;
+	auto best = table.bestAttribute(data.getTypes(), data.getData(),
+			cbegin(rows), cend(rows));
+	counting = false;
+
+	EXPECT_NE(NoAttrIndex, best);
+	EXPECT_EQ(0, allocations);
+}
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include "../src/BayesClassifier.h"
+#include "../src/CsvReader.h"
+#include "../src/Dataset.h"
+
+TEST(BayesClassifierTests, ScoresPickTheClass)
+{
+	auto data = readHeartDiseaseDataset("../data/heartDisease.csv");
+	auto classifier = std::dynamic_pointer_cast<BayesClassifier>(
+			data.classifier(ClassifierType::OPTIMAL));
+	ASSERT_TRUE(classifier);
+
+	const auto& models = classifier->getModels();
+	for (auto i = 0; i < data.size(); ++i)
+	{
+		auto scores = classifier->getScores(data.getPoint(i));
+		ASSERT_EQ(data.NumClasses, scores.rows());
+
+		// Each score is the class's log-determinant plus its distance
+		for (auto c = 0; c < models.size(); ++c)
+		{
+			EXPECT_NEAR(-models[c].getLogDeterminant()
+					- models[c].distance(data.getPoint(i)), scores[c], 1e-9);
+		}
+
+		auto type = classifier->classify(data.getPoint(i));
+		for (auto c = 0; c < scores.rows(); ++c)
+		{
+			EXPECT_LE(scores[c], scores[type - 1]);
+		}
+	}
+}
+
+TEST(BayesClassifierTests, BatchMatchesOneAtATime)
+{
+	auto data = readWineDataset("../data/wine.csv");
+
+	for (auto type : {ClassifierType::OPTIMAL, ClassifierType::NAIVE,
+			ClassifierType::LINEAR})
+	{
+		auto classifier = std::dynamic_pointer_cast<BayesClassifier>(
+				data.classifier(type));
+		ASSERT_TRUE(classifier);
+
+		auto types = classifier->classifyBatch(data.getData());
+		auto scores = classifier->getBatchScores(data.getData());
+		ASSERT_EQ(data.size(), types.rows());
+		for (auto i = 0; i < data.size(); ++i)
+		{
+			EXPECT_EQ(classifier->classify(data.getPoint(i)), types[i]);
+			EXPECT_TRUE(scores.row(i).transpose().isApprox(
+					classifier->getScores(data.getPoint(i))));
+		}
+	}
+}
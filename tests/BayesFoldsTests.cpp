@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include "../src/BayesFolds.h"
+#include "../src/CsvReader.h"
+#include "../src/Dataset.h"
+#include "../src/DatasetView.h"
+#include "../src/Partition.h"
+
+static void expectSameClassifiers(const Dataset& data, size_t numFolds)
+{
+	for (auto type : {ClassifierType::OPTIMAL, ClassifierType::NAIVE,
+			ClassifierType::LINEAR})
+	{
+		BayesFolds folds{data, type};
+		for (auto k = 1; k <= numFolds; k += numFolds / 10 + 1)
+		{
+			auto indices = kFoldIndices(k, numFolds, data.size());
+			auto partition = DatasetView{data}.partition(
+					indices.first, indices.second);
+
+			auto expected = partition.training.classifier(type);
+			auto actual = folds.classifier(partition.testing);
+			for (auto i = 0; i < data.size(); ++i)
+			{
+				EXPECT_EQ(expected->classify(data.getPoint(i)),
+						actual->classify(data.getPoint(i)));
+			}
+		}
+	}
+}
+
+TEST(BayesFoldsTests, KFoldMatchesRetraining)
+{
+	auto data = readWineDataset("../data/wine.csv");
+	data.shuffle();
+	expectSameClassifiers(data, 10);
+}
+
+TEST(BayesFoldsTests, LeaveOneOutMatchesRetraining)
+{
+	auto data = readWineDataset("../data/wine.csv");
+	expectSameClassifiers(data, data.size());
+}
+
+TEST(BayesFoldsTests, LeaveOneOutMatchesRetrainingOnIris)
+{
+	auto data = readIrisDataset("../data/iris.csv");
+	expectSameClassifiers(data, data.size());
+}
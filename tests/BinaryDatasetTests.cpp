@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include "../src/BinaryDataset.h"
+#include "../src/CsvReader.h"
+#include "../src/Dataset.h"
+#include "../src/DatasetStream.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST(BinaryDatasetTests, RoundTrip)
+{
+	const auto filename = std::string{"round-trip-test.bin"};
+	auto original = readIrisDataset("../data/iris.csv");
+	writeBinaryDataset(original, filename);
+	auto loaded = readBinaryDataset(filename);
+	std::remove(filename.c_str());
+
+	ASSERT_EQ(original.size(), loaded.size());
+	EXPECT_EQ(original.NumFields, loaded.NumFields);
+	EXPECT_EQ(original.NumClasses, loaded.NumClasses);
+	EXPECT_TRUE(original.getData() == loaded.getData());
+	EXPECT_TRUE(original.getTypes() == loaded.getTypes());
+	EXPECT_EQ(original.getNames(), loaded.getNames());
+}
+
+TEST(BinaryDatasetTests, LoadedDatasetOutlivesCopies)
+{
+	const auto filename = std::string{"outlives-test.bin"};
+	writeBinaryDataset(readWineDataset("../data/wine.csv"), filename);
+	auto loaded = readBinaryDataset(filename);
+	std::remove(filename.c_str());
+
+	// The mapping must stay valid in copies and partitions of the dataset
+	auto copy = loaded;
+	auto partition = copy.partition(0, 9);
+	EXPECT_EQ(168, partition.training.size());
+	EXPECT_EQ(copy.getPoint(0), partition.testing.getPoint(0));
+
+	// Shuffling only affects the dataset being shuffled
+	auto firstPoint = loaded.getPoint(0);
+	copy.shuffle();
+	EXPECT_EQ(firstPoint, loaded.getPoint(0));
+	EXPECT_EQ(178, copy.size());
+}
+
+/**
+ * Overwrites part of a file, to make a broken dataset out of a good one.
+ */
+template <typename T>
+static void overwrite(const std::string& filename, size_t offset,
+		const T& value)
+{
+	std::fstream file{filename,
+		std::ios::binary | std::ios::in | std::ios::out};
+	file.seekp(offset);
+	file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static BinaryDatasetHeader readHeaderOf(const std::string& filename)
+{
+	BinaryDatasetHeader header;
+	std::ifstream{filename, std::ios::binary}.read(
+			reinterpret_cast<char*>(&header), sizeof(header));
+	return header;
+}
+
+static void expectUnreadable(const std::string& filename)
+{
+	EXPECT_FALSE(isBinaryDatasetReadable(filename));
+	EXPECT_THROW(readBinaryDataset(filename), std::runtime_error);
+	EXPECT_THROW(streamBinaryDataset(filename, 10), std::runtime_error);
+}
+
+TEST(BinaryDatasetTests, RejectsTruncatedFiles)
+{
+	const auto filename = std::string{"truncated-test.bin"};
+	writeBinaryDataset(readIrisDataset("../data/iris.csv"), filename);
+	ASSERT_TRUE(isBinaryDatasetReadable(filename));
+
+	std::vector<char> contents{};
+	{
+		std::ifstream in{filename, std::ios::binary};
+		contents.assign(std::istreambuf_iterator<char>{in},
+				std::istreambuf_iterator<char>{});
+	}
+
+	// Cut off the end, and fix up the size so only the sections are wrong
+	auto header = readHeaderOf(filename);
+	const auto size = header.nameOffsetsOffset;
+	header.fileSize = size;
+	std::memcpy(contents.data(), &header, sizeof(header));
+	{
+		std::ofstream out{filename, std::ios::binary | std::ios::trunc};
+		out.write(contents.data(), size);
+	}
+	expectUnreadable(filename);
+	std::remove(filename.c_str());
+}
+
+TEST(BinaryDatasetTests, RejectsSectionsOutsideTheFile)
+{
+	const auto filename = std::string{"bad-section-test.bin"};
+	writeBinaryDataset(readIrisDataset("../data/iris.csv"), filename);
+
+	overwrite(filename, offsetof(BinaryDatasetHeader, numFields),
+			uint64_t{1} << 62);
+	expectUnreadable(filename);
+	std::remove(filename.c_str());
+}
+
+TEST(BinaryDatasetTests, RejectsBadNamesAndTypes)
+{
+	const auto filename = std::string{"bad-names-test.bin"};
+	writeBinaryDataset(readIrisDataset("../data/iris.csv"), filename);
+	const auto header = readHeaderOf(filename);
+
+	// A name that ends past the end of the names section
+	overwrite(filename, header.nameOffsetsOffset + sizeof(uint64_t),
+			uint64_t{1} << 40);
+	expectUnreadable(filename);
+
+	writeBinaryDataset(readIrisDataset("../data/iris.csv"), filename);
+	overwrite(filename, header.typesOffset, uint8_t{4});
+	expectUnreadable(filename);
+	std::remove(filename.c_str());
+}
+
+TEST(BinaryDatasetTests, OtherFilesAreNotReadable)
+{
+	EXPECT_FALSE(isBinaryDatasetReadable("../data/iris.csv"));
+	EXPECT_FALSE(isBinaryDatasetReadable("no-such-file.bin"));
+	EXPECT_THROW(readBinaryDataset("no-such-file.bin"), std::runtime_error);
+}
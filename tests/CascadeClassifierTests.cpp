@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "../src/BayesClassifier.h"
+#include "../src/CascadeClassifier.h"
+#include "../src/CsvReader.h"
+#include "../src/Dataset.h"
+#include "../src/FixedBayesClassifier.h"
+#include "../src/Preprocessing.h"
+#include <algorithm>
+#include <limits>
+
+TEST(CascadeClassifierTests, ZeroThresholdNeverEscalates)
+{
+	auto data = readWineDataset("../data/wine.csv");
+	auto linear = data.classifier(ClassifierType::LINEAR);
+	CascadeClassifier cascade{linear,
+		data.classifier(ClassifierType::OPTIMAL), 0};
+
+	for (auto i = 0; i < data.size(); ++i)
+	{
+		EXPECT_EQ(linear->classify(data.getPoint(i)),
+				cascade.classify(data.getPoint(i)));
+	}
+	EXPECT_EQ(0, cascade.getEscalatedFraction());
+}
+
+TEST(CascadeClassifierTests, InfiniteThresholdAlwaysEscalates)
+{
+	auto data = readWineDataset("../data/wine.csv");
+	auto optimal = data.classifier(ClassifierType::OPTIMAL);
+	CascadeClassifier cascade{data.classifier(ClassifierType::LINEAR),
+		optimal, std::numeric_limits<Decimal>::infinity()};
+
+	auto types = cascade.classifyBatch(data.getData());
+	for (auto i = 0; i < data.size(); ++i)
+	{
+		EXPECT_EQ(optimal->classify(data.getPoint(i)), types[i]);
+	}
+	EXPECT_EQ(1, cascade.getEscalatedFraction());
+
+	cascade.resetCounts();
+	EXPECT_EQ(0, cascade.getEscalatedFraction());
+}
+
+TEST(CascadeClassifierTests, EscalatesOnlyCloseCalls)
+{
+	auto data = readWineDataset("../data/wine.csv");
+	auto naive = std::dynamic_pointer_cast<BayesClassifier>(
+			data.classifier(ClassifierType::NAIVE));
+	auto optimal = data.classifier(ClassifierType::OPTIMAL);
+	CascadeClassifier cascade{naive, optimal, 10};
+
+	auto numClose = 0;
+	for (auto i = 0; i < data.size(); ++i)
+	{
+		auto scores = naive->getScores(data.getPoint(i));
+		std::sort(scores.data(), scores.data() + scores.rows());
+		auto close = scores[scores.rows() - 1] - scores[scores.rows() - 2] < 10;
+		numClose += close;
+
+		EXPECT_EQ(close ? optimal->classify(data.getPoint(i))
+				: naive->classify(data.getPoint(i)),
+				cascade.classify(data.getPoint(i)));
+	}
+	EXPECT_DOUBLE_EQ(numClose / static_cast<double>(data.size()),
+			cascade.getEscalatedFraction());
+}
+
+TEST(CascadeClassifierTests, FixedBayesEscalatesLikeBayes)
+{
+	auto data = readWineDataset("../data/wine.csv");
+	auto naive = data.classifier(ClassifierType::NAIVE);
+	auto fixed = specialize(naive);
+	ASSERT_EQ(nullptr, dynamic_cast<BayesClassifier*>(fixed.get()));
+	auto optimal = data.classifier(ClassifierType::OPTIMAL);
+	CascadeClassifier expected{naive, optimal, 10};
+	CascadeClassifier actual{fixed, optimal, 10};
+
+	for (auto i = 0; i < data.size(); ++i)
+	{
+		EXPECT_EQ(expected.classify(data.getPoint(i)),
+				actual.classify(data.getPoint(i)));
+	}
+	EXPECT_GT(actual.getEscalatedFraction(), 0);
+	EXPECT_DOUBLE_EQ(expected.getEscalatedFraction(),
+			actual.getEscalatedFraction());
+}
+
+TEST(CascadeClassifierTests, TreeEscalatesWhenUndecided)
+{
+	auto data = discretize(readHeartDiseaseDataset(
+			"../data/heartDisease.csv"), {0, 3, 4, 7, 9}, 3,
+			BinningMethod::EQUAL_WIDTH).dataset;
+	auto training = data.partition(0, 99).training;
+	auto tree = training.classifier(ClassifierType::DECISION_TREE);
+	auto optimal = training.classifier(ClassifierType::OPTIMAL);
+	CascadeClassifier cascade{tree, optimal, 0};
+
+	for (auto i = 0; i < data.size(); ++i)
+	{
+		auto type = tree->classify(data.getPoint(i));
+		EXPECT_EQ(type != NoType ? type : optimal->classify(data.getPoint(i)),
+				cascade.classify(data.getPoint(i)));
+	}
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "../src/ClassStatistics.h"
+#include "../src/Dataset.h"
+#include <random>
+
+// Enough rows, with the classes mixed together, that the statistics are
+// built up over several blocks
+static Dataset makeMixedDataset(size_t size, size_t numFields,
+		size_t numClasses)
+{
+	std::mt19937 generator{7};
+	std::normal_distribution<double> normal{1000.0, 3.0};
+
+	TypeVector types(size);
+	DataMatrix data(size, numFields);
+	std::vector<std::string> names(size);
+	for (auto i = 0; i < size; ++i)
+	{
+		types[i] = i % numClasses + 1;
+		for (auto j = 0; j < numFields; ++j)
+		{
+			data(i, j) = normal(generator) * (j + 1) + types[i];
+		}
+	}
+
+	return Dataset{std::move(names), std::move(types), std::move(data),
+		numClasses};
+}
+
+TEST(ClassStatisticsTests, OnePassMatchesSubsets)
+{
+	auto data = makeMixedDataset(2000, 6, 5);
+
+	ClassStatistics stats{data.NumFields, data.NumClasses};
+	stats.add(data.getData(), data.getTypes());
+
+	for (auto type = 1; type <= data.NumClasses; ++type)
+	{
+		auto subset = data.getSubsetByClass(type);
+		EXPECT_EQ(subset.size(), stats.getCount(type));
+		EXPECT_TRUE(subset.getMeans().isApprox(stats.getMeans(type)));
+		for (auto ctype : {ClassifierType::OPTIMAL, ClassifierType::NAIVE,
+				ClassifierType::LINEAR})
+		{
+			EXPECT_TRUE(subset.getCovarianceMatrix(ctype)
+					.isApprox(stats.getCovarianceMatrix(type, ctype)));
+		}
+	}
+}
+
+TEST(ClassStatisticsTests, RowListsMatchTypes)
+{
+	auto data = makeMixedDataset(1000, 4, 3);
+
+	ClassStatistics byTypes{data.NumFields, data.NumClasses};
+	byTypes.add(data.getData(), data.getTypes());
+
+	ClassStatistics byRows{data.NumFields, data.NumClasses};
+	for (auto type = 1; type <= data.NumClasses; ++type)
+	{
+		byRows.add(data.getData(), type, data.getRowsOfClass(type));
+	}
+
+	for (auto type = 1; type <= data.NumClasses; ++type)
+	{
+		EXPECT_EQ(byTypes.getCount(type), byRows.getCount(type));
+		EXPECT_TRUE(byTypes.getCovarianceMatrix(type, ClassifierType::OPTIMAL)
+				.isApprox(byRows.getCovarianceMatrix(type,
+						ClassifierType::OPTIMAL)));
+	}
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include "../src/ContingencyTable.h"
+#include "../src/CsvReader.h"
+#include "../src/Dataset.h"
+#include "../src/Preprocessing.h"
+#include <cmath>
+#include <map>
+#include <numeric>
+#include <vector>
+
+// Works out the gain of a column the long way, straight from the
+// definition
+static double slowGain(const TypeRef& types, const DataRef& data,
+		size_t column)
+{
+	auto entropyOf = [](const std::map<uint8_t, size_t>& counts)
+	{
+		size_t total = 0;
+		for (const auto& count : counts)
+		{
+			total += count.second;
+		}
+		double ret = 0;
+		for (const auto& count : counts)
+		{
+			auto p = static_cast<double>(count.second) / total;
+			ret -= p * std::log2(p);
+		}
+		return ret;
+	};
+
+	std::map<uint8_t, size_t> typeCounts{};
+	std::map<Decimal, std::map<uint8_t, size_t>> valueTypeCounts{};
+	for (auto i = 0; i < types.rows(); ++i)
+	{
+		++typeCounts[types[i]];
+		++valueTypeCounts[data(i, column)][types[i]];
+	}
+
+	auto ret = entropyOf(typeCounts);
+	for (const auto& value : valueTypeCounts)
+	{
+		size_t count = 0;
+		for (const auto& typeCount : value.second)
+		{
+			count += typeCount.second;
+		}
+		ret -= static_cast<double>(count) / types.rows()
+				* entropyOf(value.second);
+	}
+	return ret;
+}
+
+TEST(ContingencyTableTests, MatchesDefinition)
+{
+	auto data = discretize(readHeartDiseaseDataset(
+			"../data/heartDisease.csv"), {0, 3, 4, 7, 9}, 3,
+			BinningMethod::EQUAL_WIDTH).dataset;
+	std::vector<size_t> rows(data.size());
+	std::iota(begin(rows), end(rows), 0);
+	ContingencyTable table{data.size(), data.NumClasses + 1};
+
+	// Going over the columns twice checks the counts get cleared
+	for (auto repeat = 0; repeat < 2; ++repeat)
+	{
+		for (auto j = 0; j < data.NumFields; ++j)
+		{
+			EXPECT_NEAR(slowGain(data.getTypes(), data.getData(), j),
+					table.gain(data.getTypes(), data.getData(), j,
+							cbegin(rows), cend(rows)),
+					1e-12);
+		}
+	}
+}
+
+TEST(ContingencyTableTests, Entropy)
+{
+	TypeVector types{14, 1};
+	types << 1, 1, 1, 1, 1, 1, 1, 1, 1,
+			 2, 2, 2, 2, 2;
+	std::vector<size_t> rows(types.rows());
+	std::iota(begin(rows), end(rows), 0);
+	ContingencyTable table{rows.size(), 3};
+
+	EXPECT_NEAR(.94028, table.entropy(types, cbegin(rows), cend(rows)),
+			.0001);
+	EXPECT_EQ(0, table.entropy(types, cbegin(rows), cbegin(rows) + 9));
+	EXPECT_EQ(1, table.entropy(types, cbegin(rows) + 8,
+			cbegin(rows) + 10));
+}
+
+TEST(ContingencyTableTests, OneValueHasNoGain)
+{
+	TypeVector types{5, 1};
+	DataMatrix data{5, 1};
+	types << 1, 2, 3, 1, 2;
+	data << 4, 4, 4, 4, 4;
+	std::vector<size_t> rows(types.rows());
+	std::iota(begin(rows), end(rows), 0);
+	ContingencyTable table{rows.size(), 4};
+
+	EXPECT_EQ(0, table.gain(types, data, 0, cbegin(rows), cend(rows)));
+	EXPECT_EQ(NoAttrIndex, table.bestAttribute(types, data,
+			cbegin(rows), cend(rows)));
+}
+
+TEST(ContingencyTableTests, TiesGoToFirstColumn)
+{
+	TypeVector types{6, 1};
+	DataMatrix data{6, 3};
+	types << 1, 1, 2, 2, 3, 3;
+	data << 0, 5, 2,
+			0, 5, 2,
+			1, 6, 0,
+			1, 6, 0,
+			2, 7, 1,
+			1, 7, 0;
+	std::vector<size_t> rows(types.rows());
+	std::iota(begin(rows), end(rows), 0);
+	ContingencyTable table{rows.size(), 4};
+
+	EXPECT_EQ(1, table.bestAttribute(types, data, cbegin(rows), cend(rows)));
+
+	// Columns 0 and 2 tell us exactly as much as each other
+	auto sameColumns = data;
+	sameColumns.col(1).setConstant(5);
+	EXPECT_EQ(0, table.bestAttribute(types, sameColumns,
+			cbegin(rows), cend(rows)));
+}
+
+TEST(ContingencyTableTests, BestThreshold)
+{
+	TypeVector types{6, 1};
+	DataMatrix data{6, 2};
+	types << 1, 1, 2, 2, 2, 1;
+	data << 1, 0,
+			2, 0,
+			3, 0,
+			3, 0,
+			5, 0,
+			9, 0;
+	std::vector<size_t> rows(types.rows());
+	std::iota(begin(rows), end(rows), 0);
+	ContingencyTable table{rows.size(), 3};
+
+	// Splitting after the 2s leaves one row of type 1 on the right,
+	// which still beats splitting after the 5s
+	auto split = table.bestThreshold(types, data, 0, cbegin(rows), cend(rows));
+	EXPECT_EQ(2, split.numLeft);
+	EXPECT_EQ(2.5, split.threshold);
+
+	DataMatrix sides{6, 1};
+	sides << 0, 0, 1, 1, 1, 1;
+	EXPECT_NEAR(table.gain(types, sides, 0, cbegin(rows), cend(rows)),
+			split.gain, 1e-12);
+
+	// There's nowhere to split a column with only one value
+	split = table.bestThreshold(types, data, 1, cbegin(rows), cend(rows));
+	EXPECT_EQ(0, split.gain);
+	EXPECT_EQ(0, split.numLeft);
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "../src/CsvReader.h"
+#include "../src/Dataset.h"
+#include "../src/DatasetStream.h"
+#include "../src/Types.h"
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+TEST(CsvReaderTests, ReadsEveryLine)
+{
+	EXPECT_EQ(150, readIrisDataset("../data/iris.csv").size());
+	EXPECT_EQ(178, readWineDataset("../data/wine.csv").size());
+	EXPECT_EQ(284, readHeartDiseaseDataset("../data/heartDisease.csv").size());
+}
+
+TEST(CsvReaderTests, FieldsMatchStod)
+{
+	auto data = readWineDataset("../data/wine.csv");
+	auto first = data.getPoint(0);
+
+	ASSERT_EQ(WineFields, first.cols());
+	EXPECT_EQ(static_cast<Decimal>(std::stod("14.23")), first[0]);
+	EXPECT_EQ(static_cast<Decimal>(std::stod("1.71")), first[1]);
+	EXPECT_EQ(static_cast<Decimal>(std::stod("1065")), first[12]);
+	EXPECT_EQ(1, data.getType(0));
+}
+
+TEST(CsvReaderTests, IrisTypesWithDosLineEndings)
+{
+	auto data = readIrisDataset("../data/iris.csv");
+
+	EXPECT_EQ(static_cast<Decimal>(std::stod("5.1")), data.getPoint(0)[0]);
+	EXPECT_EQ(static_cast<Decimal>(std::stod("0.2")), data.getPoint(0)[3]);
+	EXPECT_EQ(1, data.getType(0));
+	EXPECT_EQ(2, data.getType(50));
+	EXPECT_EQ(3, data.getType(149));
+}
+
+TEST(CsvReaderTests, HeartDiseaseTypesAreShifted)
+{
+	auto data = readHeartDiseaseDataset("../data/heartDisease.csv");
+
+	EXPECT_EQ(static_cast<Decimal>(std::stod("2.3")), data.getPoint(0)[9]);
+	EXPECT_EQ(1, data.getType(0));
+	for (auto i = 0; i < data.size(); ++i)
+	{
+		EXPECT_GE(data.getType(i), 1);
+		EXPECT_LE(data.getType(i), HeartDiseaseClasses);
+	}
+}
+
+TEST(CsvReaderTests, ParallelMatchesSerial)
+{
+	// Make a file big enough to be split between several threads
+	const auto filename = std::string{"parallel-ingest-test.csv"};
+	{
+		auto in = std::ifstream{"../data/wine.csv"};
+		auto wine = std::string{std::istreambuf_iterator<char>{in},
+			std::istreambuf_iterator<char>{}};
+		auto out = std::ofstream{filename};
+		for (auto i = 0; i < 100; ++i)
+		{
+			out << wine;
+		}
+	}
+
+	auto serial = readWineDataset(filename, 1);
+	auto parallel = readWineDataset(filename, 8);
+	std::remove(filename.c_str());
+
+	ASSERT_EQ(178 * 100, serial.size());
+	ASSERT_EQ(serial.size(), parallel.size());
+	EXPECT_TRUE(serial.getData() == parallel.getData());
+	for (auto i = 0; i < serial.size(); ++i)
+	{
+		EXPECT_EQ(serial.getType(i), parallel.getType(i));
+	}
+}
+
+TEST(CsvReaderTests, RejectsFieldsThatAreTooLong)
+{
+	const auto filename = std::string{"long-field-test.csv"};
+	{
+		auto out = std::ofstream{filename};
+		out << "5.1,3.5,1.4,0.2,Iris-setosa" << std::endl
+			<< "4.9," << std::string(200, '3') << ",1.4,0.2,Iris-setosa"
+			<< std::endl;
+	}
+
+	EXPECT_THROW(readIrisDataset(filename), std::runtime_error);
+	std::remove(filename.c_str());
+}
+
+TEST(CsvReaderTests, ParallelRejectsBadFields)
+{
+	const auto filename = std::string{"parallel-bad-field-test.csv"};
+	{
+		auto in = std::ifstream{"../data/wine.csv"};
+		auto wine = std::string{std::istreambuf_iterator<char>{in},
+			std::istreambuf_iterator<char>{}};
+		auto out = std::ofstream{filename};
+		for (auto i = 0; i < 100; ++i)
+		{
+			out << wine;
+		}
+		out << "14.23,x,2.43,15.6,127,2.8,3.06,0.28,2.29,5.64,1.04,3.92,1065,1"
+			<< std::endl;
+	}
+
+	EXPECT_THROW(readWineDataset(filename, 8), std::runtime_error);
+	std::remove(filename.c_str());
+}
+
+TEST(CsvReaderTests, RejectsMissingFiles)
+{
+	EXPECT_THROW(readIrisDataset("../data/no-such-file.csv"),
+			std::runtime_error);
+	EXPECT_THROW(streamIrisDataset("../data/no-such-file.csv", 10),
+			std::runtime_error);
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "../src/BinaryDataset.h"
+#include "../src/ClassStatistics.h"
+#include "../src/CsvReader.h"
+#include "../src/Dataset.h"
+#include "../src/DatasetStream.h"
+#include <cstdio>
+#include <string>
+
+TEST(DatasetStreamTests, CsvBatchesCoverWholeFile)
+{
+	auto data = readWineDataset("../data/wine.csv");
+	auto stream = streamWineDataset("../data/wine.csv", 50);
+
+	DatasetBatch batch{};
+	auto row = 0;
+	while (stream->next(batch))
+	{
+		EXPECT_TRUE(batch.size() == 50 || row + batch.size() == data.size());
+		for (auto i = 0; i < batch.size(); ++i, ++row)
+		{
+			EXPECT_EQ(data.getPoint(row), batch.data.row(i));
+			EXPECT_EQ(data.getType(row), batch.types[i]);
+		}
+	}
+	EXPECT_EQ(data.size(), row);
+	EXPECT_FALSE(stream->next(batch));
+}
+
+TEST(DatasetStreamTests, BinaryBatchesCoverWholeFile)
+{
+	const auto filename = std::string{"stream-test.bin"};
+	auto data = readIrisDataset("../data/iris.csv");
+	writeBinaryDataset(data, filename);
+	auto stream = streamBinaryDataset(filename, 64);
+	std::remove(filename.c_str());
+
+	DatasetBatch batch{};
+	auto row = 0;
+	while (stream->next(batch))
+	{
+		for (auto i = 0; i < batch.size(); ++i, ++row)
+		{
+			EXPECT_EQ(data.getPoint(row), batch.data.row(i));
+			EXPECT_EQ(data.getType(row), batch.types[i]);
+		}
+	}
+	EXPECT_EQ(data.size(), row);
+}
+
+TEST(DatasetStreamTests, StatisticsMatchWholeDataset)
+{
+	auto data = readWineDataset("../data/wine.csv");
+	auto stream = streamWineDataset("../data/wine.csv", 16);
+	ClassStatistics stats{WineFields, WineClasses};
+	stats.add(*stream);
+
+	for (auto type = 1; type <= WineClasses; ++type)
+	{
+		auto subset = data.getSubsetByClass(type);
+		EXPECT_EQ(subset.size(), stats.getCount(type));
+		EXPECT_TRUE(subset.getMeans().isApprox(stats.getMeans(type)));
+		EXPECT_TRUE(subset.getCovarianceMatrix(ClassifierType::OPTIMAL)
+				.isApprox(stats.getCovarianceMatrix(type,
+						ClassifierType::OPTIMAL)));
+	}
+}
+
+TEST(DatasetStreamTests, ClassifierMatchesWholeDataset)
+{
+	auto data = readIrisDataset("../data/iris.csv");
+	auto stream = streamIrisDataset("../data/iris.csv", 32);
+	ClassStatistics stats{IrisFields, IrisClasses};
+	stats.add(*stream);
+
+	for (auto type : {ClassifierType::OPTIMAL, ClassifierType::NAIVE,
+			ClassifierType::LINEAR})
+	{
+		auto expected = data.classifier(type);
+		auto actual = stats.classifier(type);
+
+		// Predict a batch at a time, as we would for a huge dataset
+		auto predictStream = streamIrisDataset("../data/iris.csv", 32);
+		DatasetBatch batch{};
+		auto row = 0;
+		while (predictStream->next(batch))
+		{
+			for (auto i = 0; i < batch.size(); ++i, ++row)
+			{
+				EXPECT_EQ(expected->classify(data.getPoint(row)),
+						actual->classify(batch.data.row(i)));
+			}
+		}
+	}
+}
@@ -44,3 +44,38 @@ TEST(DatasetTests, PartitionForKFold)
 	EXPECT_EQ(178-46, partition.training.size());
 	EXPECT_EQ(46, partition.testing.size());
 }
+
+TEST(DatasetTests, SubsetByClass)
+{
+	auto data = readWineDataset("../data/wine.csv");
+
+	size_t total = 0;
+	for (auto type = 1; type <= data.NumClasses; ++type)
+	{
+		auto subset = data.getSubsetByClass(type);
+		EXPECT_EQ(data.getRowsOfClass(type).size(), subset.size());
+		EXPECT_EQ(subset.size(), subset.getNames().size());
+		for (auto i = 0; i < subset.size(); ++i)
+		{
+			EXPECT_EQ(type, subset.getType(i));
+		}
+		total += subset.size();
+	}
+	EXPECT_EQ(data.size(), total);
+}
+
+TEST(DatasetTests, ClassIndexFollowsShuffle)
+{
+	auto data = readWineDataset("../data/wine.csv");
+	data.shuffle();
+
+	for (auto type = 1; type <= data.NumClasses; ++type)
+	{
+		const auto& rows = data.getRowsOfClass(type);
+		EXPECT_TRUE(std::is_sorted(rows.begin(), rows.end()));
+		for (auto row : rows)
+		{
+			EXPECT_EQ(type, data.getType(row));
+		}
+	}
+}
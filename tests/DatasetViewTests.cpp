@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include "../src/CsvReader.h"
+#include "../src/Dataset.h"
+#include "../src/DatasetView.h"
+#include "../src/DecisionTree.h"
+#include "../src/Partition.h"
+#include "../src/Preprocessing.h"
+#include <algorithm>
+#include <sstream>
+
+TEST(DatasetViewTests, PartitionMatchesDataset)
+{
+	auto data = readWineDataset("../data/wine.csv");
+
+	for (auto k = 1; k <= 4; ++k)
+	{
+		auto indices = kFoldIndices(k, 4, data.size());
+		auto copied = data.partition(indices.first, indices.second);
+		auto viewed = DatasetView{data}.partition(
+				indices.first, indices.second);
+
+		ASSERT_EQ(copied.training.size(), viewed.training.size());
+		ASSERT_EQ(copied.testing.size(), viewed.testing.size());
+		for (auto i = 0; i < viewed.training.size(); ++i)
+		{
+			EXPECT_EQ(copied.training.getPoint(i),
+					viewed.training.getPoint(i));
+			EXPECT_EQ(copied.training.getType(i),
+					viewed.training.getType(i));
+		}
+		for (auto i = 0; i < viewed.testing.size(); ++i)
+		{
+			EXPECT_EQ(copied.testing.getPoint(i), viewed.testing.getPoint(i));
+		}
+	}
+}
+
+TEST(DatasetViewTests, PartitionOfPartition)
+{
+	auto data = readIrisDataset("../data/iris.csv");
+	auto outer = DatasetView{data}.partition(50, 99);
+	ASSERT_EQ(2, outer.training.getSpans().size());
+
+	// Testing rows straddle the gap where the outer testing set was
+	auto inner = outer.training.partition(40, 59);
+	EXPECT_EQ(20, inner.testing.size());
+	EXPECT_EQ(80, inner.training.size());
+	EXPECT_EQ(data.getPoint(40), inner.testing.getPoint(0));
+	EXPECT_EQ(data.getPoint(100), inner.testing.getPoint(10));
+	EXPECT_EQ(data.getPoint(109), inner.testing.getPoint(19));
+	EXPECT_EQ(data.getPoint(110), inner.training.getPoint(40));
+}
+
+TEST(DatasetViewTests, RowsOfClass)
+{
+	auto data = readIrisDataset("../data/iris.csv");
+	auto view = DatasetView{data}.partition(40, 109).training;
+
+	// Iris is sorted by class, so each class loses the rows in [40, 109]
+	EXPECT_EQ(40, view.getRowsOfClass(1).size());
+	EXPECT_EQ(0, view.getRowsOfClass(2).size());
+	EXPECT_EQ(40, view.getRowsOfClass(3).size());
+	EXPECT_EQ(39, view.getRowsOfClass(1).back());
+	EXPECT_EQ(110, view.getRowsOfClass(3).front());
+}
+
+TEST(DatasetViewTests, BayesClassifierMatchesCopy)
+{
+	auto data = readWineDataset("../data/wine.csv");
+	auto copied = data.partition(60, 79);
+	auto viewed = DatasetView{data}.partition(60, 79);
+
+	for (auto type : {ClassifierType::OPTIMAL, ClassifierType::NAIVE,
+			ClassifierType::LINEAR})
+	{
+		auto expected = copied.training.classifier(type);
+		auto actual = viewed.training.classifier(type);
+		for (auto i = 0; i < data.size(); ++i)
+		{
+			EXPECT_EQ(expected->classify(data.getPoint(i)),
+					actual->classify(data.getPoint(i)));
+		}
+	}
+}
+
+TEST(DatasetViewTests, DecisionTreeMatchesCopy)
+{
+	auto data = discretize(readIrisDataset("../data/iris.csv"),
+			{0, 1, 2, 3}, 3, BinningMethod::EQUAL_WIDTH).dataset;
+	auto copied = data.partition(10, 29);
+	auto viewed = DatasetView{data}.partition(10, 29);
+
+	DecisionTree expected{copied.training.getTypes(),
+		copied.training.getData()};
+	DecisionTree actual{viewed.training};
+
+	std::stringstream expectedDot;
+	std::stringstream actualDot;
+	expectedDot << expected;
+	actualDot << actual;
+	EXPECT_EQ(expectedDot.str(), actualDot.str());
+}
+
+TEST(DatasetViewTests, ShuffledHasEveryRowOnce)
+{
+	auto data = readIrisDataset("../data/iris.csv");
+	auto shuffled = DatasetView{data}.shuffled();
+	ASSERT_EQ(data.size(), shuffled.size());
+
+	auto rows = shuffled.getRowIndices();
+	auto points = shuffled.getPoints();
+	for (auto i = 0; i < shuffled.size(); ++i)
+	{
+		EXPECT_EQ(data.getType(rows[i]), shuffled.getType(i));
+		EXPECT_EQ(data.getPoint(rows[i]), shuffled.getPoint(i));
+		EXPECT_EQ(data.getPoint(rows[i]), points.row(i));
+	}
+	std::sort(begin(rows), end(rows));
+	EXPECT_EQ(DatasetView{data}.getRowIndices(), rows);
+
+	// Folds of the shuffled view still cover every row, in a span or two
+	auto partitions = shuffled.partition(10, 24);
+	EXPECT_EQ(15, partitions.testing.size());
+	EXPECT_EQ(data.size() - 15, partitions.training.size());
+	EXPECT_EQ(1, partitions.testing.getSpans().size());
+	EXPECT_EQ(2, partitions.training.getSpans().size());
+	for (auto i = 0; i < partitions.testing.size(); ++i)
+	{
+		EXPECT_EQ(shuffled.getType(10 + i), partitions.testing.getType(i));
+	}
+}
+
+TEST(DatasetViewTests, ShuffledFoldsTrainLikeCopies)
+{
+	auto data = readWineDataset("../data/wine.csv");
+	auto shuffled = DatasetView{data}.shuffled();
+	auto partitions = shuffled.partition(30, 59);
+
+	// The same rows, copied out into a dataset of their own
+	auto rows = partitions.training.getRowIndices();
+	std::sort(begin(rows), end(rows));
+	TypeVector types(rows.size());
+	DataMatrix points(rows.size(), data.NumFields);
+	for (auto i = 0; i < rows.size(); ++i)
+	{
+		types[i] = data.getType(rows[i]);
+		points.row(i) = data.getPoint(rows[i]);
+	}
+	Dataset copied{std::vector<std::string>(rows.size()), types, points,
+		data.NumClasses};
+
+	for (auto type : {ClassifierType::OPTIMAL, ClassifierType::NAIVE,
+			ClassifierType::LINEAR})
+	{
+		auto expected = copied.classifier(type);
+		auto actual = partitions.training.classifier(type);
+		for (auto i = 0; i < data.size(); ++i)
+		{
+			EXPECT_EQ(expected->classify(data.getPoint(i)),
+					actual->classify(data.getPoint(i)));
+		}
+	}
+}
@@ -1,7 +1,12 @@
 #include <gtest/gtest.h>
 #include "../src/DecisionTree.h"
+#include "../src/CsvReader.h"
 #include "../src/Dataset.h"
+#include "../src/Preprocessing.h"
 #include "../src/Types.h"
+#include <random>
+#include <type_traits>
+#include <sstream>
 
 // Entropy tests
 
@@ -241,4 +246,218 @@ TEST(DecisionTreeTests, IrisData)
 	}
 }
 
+TEST(DecisionTreeTests, UnseenValues)
+{
+	TypeVector types{4, 1};
+	DataMatrix data{4, 2};
+	types << 1, 1, 2, 2;
+	data << 1, 5,
+			1, 5,
+			2, 5,
+			3, 5;
+
+	DecisionTree dt{types, data};
+	ASSERT_EQ(4, dt.getFlatTree().nodes.size());
+
+	RowVector point{2};
+	point << 4, 5;
+	EXPECT_EQ(NoType, dt.classify(point));
+	point << 0, 5;
+	EXPECT_EQ(NoType, dt.classify(point));
+	point << 1.5, 5;
+	EXPECT_EQ(NoType, dt.classify(point));
+	point << -1, 5;
+	EXPECT_EQ(NoType, dt.classify(point));
+	point << 3, 7;
+	EXPECT_EQ(2, dt.classify(point));
+}
+
+TEST(DecisionTreeTests, BatchMatchesOneAtATime)
+{
+	auto data = discretize(readIrisDataset("../data/iris.csv"),
+			{0, 1, 2, 3}, 3, BinningMethod::EQUAL_WIDTH).dataset;
+	DecisionTree tree{data.getTypes(), data.getData()};
+
+	auto types = tree.classifyBatch(data.getData());
+	ASSERT_EQ(data.size(), types.rows());
+	for (auto i = 0; i < data.size(); ++i)
+	{
+		EXPECT_EQ(tree.classify(data.getPoint(i)), types[i]);
+	}
+}
+
+TEST(DecisionTreeTests, ParallelMatchesSerial)
+{
+	// Enough noisy rows that the tree is big, and the top nodes work
+	// out their gains in parallel
+	std::mt19937 random{42};
+	std::uniform_int_distribution<int> value{0, 3};
+	std::bernoulli_distribution noise{.2};
+	const auto numRows = 20000;
+	TypeVector types(numRows);
+	DataMatrix data(numRows, 8);
+	for (auto i = 0; i < numRows; ++i)
+	{
+		for (auto j = 0; j < data.cols(); ++j)
+		{
+			data(i, j) = value(random);
+		}
+		types[i] = noise(random) ? value(random) + 1
+				: static_cast<uint8_t>(data(i, 2) + data(i, 5)) % 4 + 1;
+	}
+
+	DecisionTree serial{types, data};
+	DecisionTree parallel{types, data, SplitMethod::BY_VALUE, 4};
+
+	std::ostringstream serialGraph{};
+	std::ostringstream parallelGraph{};
+	serialGraph << serial;
+	parallelGraph << parallel;
+	EXPECT_EQ(serialGraph.str(), parallelGraph.str());
+
+	EXPECT_TRUE(parallel.classifyBatch(data) == serial.classifyBatch(data));
+}
+
+TEST(DecisionTreeTests, ThresholdsGoBetweenValues)
+{
+	TypeVector types{4, 1};
+	DataMatrix data{4, 1};
+	types << 1, 1, 2, 2;
+	data << 1, 2, 4, 8;
+
+	DecisionTree dt{types, data, SplitMethod::BY_THRESHOLD};
+	const auto& flat = dt.getFlatTree();
+	ASSERT_EQ(3, flat.nodes.size());
+	EXPECT_EQ(ThresholdNode, flat.nodes[0].numValues);
+	EXPECT_EQ(3, flat.thresholds[0]);
+
+	// Values the tree never saw still go one way or the other
+	RowVector point{1};
+	point << 3;
+	EXPECT_EQ(1, dt.classify(point));
+	point << 3.5;
+	EXPECT_EQ(2, dt.classify(point));
+	point << -100;
+	EXPECT_EQ(1, dt.classify(point));
+	point << 100;
+	EXPECT_EQ(2, dt.classify(point));
+}
 
+TEST(DecisionTreeTests, ThresholdTreeOnRawData)
+{
+	auto data = readIrisDataset("../data/iris.csv");
+	DecisionTree dt{data.getTypes(), data.getData(),
+		SplitMethod::BY_THRESHOLD};
+
+	// Every split is binary, and attributes can be split on again
+	// further down
+	const auto& flat = dt.getFlatTree();
+	EXPECT_EQ(flat.nodes.size(), flat.thresholds.size());
+	EXPECT_EQ(flat.nodes.size() - 1, flat.childTable.size());
+
+	auto types = dt.classifyBatch(data.getData());
+	auto numRight = 0;
+	for (auto i = 0; i < data.size(); ++i)
+	{
+		numRight += types[i] == data.getType(i);
+	}
+	EXPECT_GE(numRight, data.size() - 1);
+}
+
+TEST(DecisionTreeTests, ThresholdParallelMatchesSerial)
+{
+	std::mt19937 random{42};
+	std::normal_distribution<double> value{0, 1};
+	std::bernoulli_distribution noise{.2};
+	const auto numRows = 20000;
+	TypeVector types(numRows);
+	DataMatrix data(numRows, 8);
+	for (auto i = 0; i < numRows; ++i)
+	{
+		for (auto j = 0; j < data.cols(); ++j)
+		{
+			data(i, j) = value(random);
+		}
+		types[i] = (data(i, 2) + data(i, 5) > 0) + (data(i, 7) > 1)
+				+ noise(random) + 1;
+	}
+
+	DecisionTree serial{types, data, SplitMethod::BY_THRESHOLD};
+	DecisionTree parallel{types, data, SplitMethod::BY_THRESHOLD, 4};
+
+	std::ostringstream serialGraph{};
+	std::ostringstream parallelGraph{};
+	serialGraph << serial;
+	parallelGraph << parallel;
+	EXPECT_EQ(serialGraph.str(), parallelGraph.str());
+
+	EXPECT_TRUE(parallel.classifyBatch(data) == serial.classifyBatch(data));
+}
+
+TEST(DecisionTreeTests, SourceForValueSplits)
+{
+	TypeVector types{4, 1};
+	DataMatrix data{4, 2};
+	types << 1, 1, 2, 2;
+	data << 1, 5,
+			1, 5,
+			2, 5,
+			3, 5;
+
+	DecisionTree dt{types, data};
+	std::ostringstream source{};
+	dt.printSource(source, "classifyTest");
+
+	EXPECT_NE(std::string::npos, source.str().find(
+			"inline std::uint8_t classifyTest(const "));
+	EXPECT_NE(std::string::npos, source.str().find(
+			"\tif (!(point[0] >= 0 && point[0] < 4)"
+			" || point[0] != static_cast<int>(point[0]))\n"
+			"\t{\n"
+			"\t\treturn 255;\n"
+			"\t}\n"
+			"\tswitch (static_cast<int>(point[0]))\n"
+			"\t{\n"
+			"\tcase 1:\n"
+			"\t{\n"
+			"\t\treturn 1;\n"
+			"\t}\n"
+			"\tcase 2:\n"
+			"\t{\n"
+			"\t\treturn 2;\n"
+			"\t}\n"
+			"\tcase 3:\n"
+			"\t{\n"
+			"\t\treturn 2;\n"
+			"\t}\n"
+			"\tdefault:\n"
+			"\t\treturn 255;\n"
+			"\t}\n"
+			"}\n"));
+}
+
+TEST(DecisionTreeTests, SourceForThresholdSplits)
+{
+	TypeVector types{4, 1};
+	DataMatrix data{4, 1};
+	types << 1, 1, 2, 2;
+	data << 1, 2, 4.5, 8;
+
+	DecisionTree dt{types, data, SplitMethod::BY_THRESHOLD};
+	std::ostringstream source{};
+	dt.printSource(source);
+
+	// Thresholds are written as literals of the same type as Decimal
+	const auto suffix = std::is_same<Decimal, float>::value ? "f"
+			: std::is_same<Decimal, double>::value ? "" : "L";
+	EXPECT_NE(std::string::npos, source.str().find(
+			std::string{"\tif (point[0] > 3.25"} + suffix + ")\n"
+			"\t{\n"
+			"\t\treturn 2;\n"
+			"\t}\n"
+			"\telse\n"
+			"\t{\n"
+			"\t\treturn 1;\n"
+			"\t}\n"
+			"}\n"));
+}
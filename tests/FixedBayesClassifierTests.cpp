@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include "../src/BayesClassifier.h"
+#include "../src/CsvReader.h"
+#include "../src/Dataset.h"
+#include "../src/DecisionTree.h"
+#include "../src/FixedBayesClassifier.h"
+#include "../src/Preprocessing.h"
+
+static void expectSameAsDynamic(const Dataset& data)
+{
+	for (auto type : {ClassifierType::OPTIMAL, ClassifierType::NAIVE,
+			ClassifierType::LINEAR})
+	{
+		auto dynamic = data.classifier(type);
+		auto fixed = specialize(dynamic);
+		ASSERT_NE(dynamic, fixed);
+
+		auto types = fixed->classifyBatch(data.getData());
+		for (auto i = 0; i < data.size(); ++i)
+		{
+			EXPECT_EQ(dynamic->classify(data.getPoint(i)),
+					fixed->classify(data.getPoint(i)));
+			EXPECT_EQ(dynamic->classify(data.getPoint(i)), types[i]);
+		}
+	}
+}
+
+TEST(FixedBayesClassifierTests, IrisMatchesDynamic)
+{
+	expectSameAsDynamic(readIrisDataset("../data/iris.csv"));
+}
+
+TEST(FixedBayesClassifierTests, WineMatchesDynamic)
+{
+	expectSameAsDynamic(readWineDataset("../data/wine.csv"));
+}
+
+TEST(FixedBayesClassifierTests, HeartDiseaseMatchesDynamic)
+{
+	expectSameAsDynamic(readHeartDiseaseDataset("../data/heartDisease.csv"));
+}
+
+TEST(FixedBayesClassifierTests, ScoresMatchDynamic)
+{
+	auto data = readWineDataset("../data/wine.csv");
+
+	// Naive and linear Bayes are scored one field at a time, and optimal
+	// Bayes with the whitening matrices
+	for (auto type : {ClassifierType::OPTIMAL, ClassifierType::NAIVE,
+			ClassifierType::LINEAR})
+	{
+		auto dynamic = std::dynamic_pointer_cast<BayesClassifier>(
+				data.classifier(type));
+		FixedBayesClassifier<WineFields, WineClasses> fixed{*dynamic};
+
+		for (auto i = 0; i < data.size(); i += 5)
+		{
+			EXPECT_TRUE(fixed.getScores(data.getPoint(i)).isApprox(
+					dynamic->getScores(data.getPoint(i))));
+		}
+	}
+}
+
+TEST(FixedBayesClassifierTests, OtherClassifiersAreLeftAlone)
+{
+	auto data = discretize(readIrisDataset("../data/iris.csv"),
+			{0, 1, 2, 3}, 3, BinningMethod::EQUAL_WIDTH).dataset;
+	auto tree = data.classifier(ClassifierType::DECISION_TREE);
+	EXPECT_EQ(tree, specialize(tree));
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include "../src/CsvReader.h"
+#include "../src/Dataset.h"
+#include "../src/GaussianModel.h"
+#include <cmath>
+#include <type_traits>
+
+// Floats can only get so close
+const Decimal Tolerance = std::is_same<Decimal, float>::value ? 1e-3 : 1e-9;
+
+TEST(GaussianModelTests, MatchesInverseAndDeterminant)
+{
+	auto data = readWineDataset("../data/wine.csv");
+	auto subset = data.getSubsetByClass(2);
+	auto covariance = subset.getCovarianceMatrix(ClassifierType::OPTIMAL);
+	auto inverse = covariance.inverse();
+
+	GaussianModel model{subset.getMeans(), covariance};
+	ASSERT_FALSE(model.isSingular());
+	EXPECT_NEAR(std::log(covariance.determinant()),
+			model.getLogDeterminant(), Tolerance);
+
+	for (auto i = 0; i < data.size(); i += 7)
+	{
+		RowVector offset = data.getPoint(i) - subset.getMeans();
+		Decimal expected = offset * inverse * offset.transpose();
+		EXPECT_NEAR(1, model.distance(data.getPoint(i)) / expected, Tolerance);
+	}
+}
+
+TEST(GaussianModelTests, SingularFallsBackToPseudoInverse)
+{
+	// The third field is the sum of the first two, so it adds nothing
+	CovarianceMatrix covariance(3, 3);
+	covariance << 2, 0, 2,
+			0, 3, 3,
+			2, 3, 5;
+	RowVector mean = RowVector::Zero(3);
+
+	GaussianModel model{mean, covariance};
+	EXPECT_TRUE(model.isSingular());
+
+	RowVector point(3);
+	point << 1, 1, 2;
+	EXPECT_NEAR(1.0/2 + 1.0/3, model.distance(point), Tolerance);
+
+	// The pseudo-determinant is the product of the non-zero eigenvalues,
+	// which here is the sum of the 2x2 principal minors
+	EXPECT_NEAR(std::log(18.0), model.getLogDeterminant(), Tolerance);
+}
+
+TEST(GaussianModelTests, RemovePointMatchesRefitting)
+{
+	auto data = readIrisDataset("../data/iris.csv");
+	auto subset = data.getSubsetByClass(3);
+
+	GaussianModel model{subset.getMeans(),
+		subset.getCovarianceMatrix(ClassifierType::OPTIMAL)};
+	ASSERT_TRUE(model.removePoint(subset.getPoint(0), subset.size()));
+
+	auto rest = subset.partition(0, 0).training;
+	GaussianModel refit{rest.getMeans(),
+		rest.getCovarianceMatrix(ClassifierType::OPTIMAL)};
+	EXPECT_TRUE(model.getMean().isApprox(refit.getMean()));
+	EXPECT_NEAR(refit.getLogDeterminant(), model.getLogDeterminant(), Tolerance);
+	for (auto i = 0; i < data.size(); i += 11)
+	{
+		EXPECT_NEAR(1, model.distance(data.getPoint(i))
+				/ refit.distance(data.getPoint(i)), Tolerance);
+	}
+}
+
+TEST(GaussianModelTests, DiagonalMatchesFull)
+{
+	auto data = readWineDataset("../data/wine.csv");
+	auto subset = data.getSubsetByClass(1);
+	auto covariance = subset.getCovarianceMatrix(ClassifierType::NAIVE);
+
+	GaussianModel full{subset.getMeans(), covariance};
+	GaussianModel diagonal{subset.getMeans(),
+		DiagonalMatrix{covariance.diagonal()}};
+	EXPECT_NEAR(full.getLogDeterminant(), diagonal.getLogDeterminant(), Tolerance);
+
+	ColVector fullDistances(data.size());
+	ColVector diagonalDistances(data.size());
+	DataMatrix workspace{};
+	full.distances(data.getData(), workspace, fullDistances);
+	diagonal.distances(data.getData(), workspace, diagonalDistances);
+	EXPECT_TRUE(fullDistances.isApprox(diagonalDistances));
+}
+
+TEST(GaussianModelTests, IdentityMatchesFull)
+{
+	auto data = readIrisDataset("../data/iris.csv");
+	auto mean = data.getMeans();
+
+	GaussianModel full{mean, CovarianceMatrix::Identity(4, 4)};
+	GaussianModel identity{mean};
+	EXPECT_EQ(0, identity.getLogDeterminant());
+	for (auto i = 0; i < data.size(); i += 9)
+	{
+		EXPECT_NEAR(full.distance(data.getPoint(i)),
+				identity.distance(data.getPoint(i)), Tolerance);
+	}
+}
+
+TEST(GaussianModelTests, DiagonalRemovePointMatchesRefitting)
+{
+	auto data = readIrisDataset("../data/iris.csv");
+	auto subset = data.getSubsetByClass(2);
+	auto covariance = DiagonalMatrix{subset.getCovarianceMatrix(
+			ClassifierType::NAIVE).diagonal()};
+
+	GaussianModel model{subset.getMeans(), covariance};
+	ASSERT_TRUE(model.removePoint(subset.getPoint(5), subset.size()));
+
+	auto rest = subset.partition(5, 5).training;
+	GaussianModel refit{rest.getMeans(), DiagonalMatrix{
+		rest.getCovarianceMatrix(ClassifierType::NAIVE).diagonal()}};
+	EXPECT_NEAR(refit.getLogDeterminant(), model.getLogDeterminant(), Tolerance);
+	EXPECT_NEAR(refit.distance(data.getPoint(0)),
+			model.distance(data.getPoint(0)), Tolerance);
+}
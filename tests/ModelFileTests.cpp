@@ -0,0 +1,234 @@
+#include <gtest/gtest.h>
+#include "../src/ModelFile.h"
+#include "../src/CsvReader.h"
+#include "../src/Dataset.h"
+#include "../src/Preprocessing.h"
+#include "../src/RandomForest.h"
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+TEST(ModelFileTests, BayesRoundTrip)
+{
+	const auto filename = std::string{"bayes-round-trip-test.model"};
+	auto data = readWineDataset("../data/wine.csv");
+	auto partitions = data.partition(0, 29);
+
+	for (auto type : {ClassifierType::OPTIMAL, ClassifierType::NAIVE,
+			ClassifierType::LINEAR})
+	{
+		auto original = partitions.training.classifier(type);
+		saveModel(*original, filename);
+		ASSERT_TRUE(isModelFileReadable(filename));
+		auto loaded = loadModel(filename);
+		std::remove(filename.c_str());
+
+		for (auto i = 0; i < data.size(); ++i)
+		{
+			EXPECT_EQ(original->classify(data.getPoint(i)),
+					loaded->classify(data.getPoint(i)));
+		}
+	}
+}
+
+/**
+ * How big a file is, in bytes.
+ */
+static size_t fileSize(const std::string& filename)
+{
+	std::ifstream file{filename, std::ios::binary | std::ios::ate};
+	return static_cast<size_t>(file.tellg());
+}
+
+TEST(ModelFileTests, DiagonalModelsOnlySaveDiagonals)
+{
+	const auto filename = std::string{"diagonal-test.model"};
+	auto data = readWineDataset("../data/wine.csv");
+
+	saveModel(*data.classifier(ClassifierType::OPTIMAL), filename);
+	const auto fullSize = fileSize(filename);
+	saveModel(*data.classifier(ClassifierType::NAIVE), filename);
+	const auto diagonalSize = fileSize(filename);
+	saveModel(*data.classifier(ClassifierType::LINEAR), filename);
+	const auto identitySize = fileSize(filename);
+	std::remove(filename.c_str());
+
+	// 3 classes of 13 x 13 matrices, 13 inverse variances, or nothing,
+	// give or take the padding between sections
+	const auto saved = 3 * 12 * 13 * sizeof(Decimal);
+	EXPECT_LE(fullSize - diagonalSize, saved + ModelFileAlignment);
+	EXPECT_GE(fullSize - diagonalSize + ModelFileAlignment, saved);
+	EXPECT_LT(identitySize, diagonalSize);
+}
+
+TEST(ModelFileTests, SingularBayesRoundTrip)
+{
+	const auto filename = std::string{"singular-round-trip-test.model"};
+
+	// Every point of a class has the same second field, so that class's
+	// covariance is singular
+	auto data = readIrisDataset("../data/iris.csv");
+	DataMatrix points = data.getData();
+	for (auto i = 0; i < data.size(); ++i)
+	{
+		if (data.getType(i) == 1)
+		{
+			points(i, 1) = 3;
+		}
+	}
+	Dataset singular{data.getNames(), data.getTypes(), points,
+		data.NumClasses};
+
+	auto original = singular.classifier(ClassifierType::OPTIMAL);
+	saveModel(*original, filename);
+	auto loaded = loadModel(filename);
+	std::remove(filename.c_str());
+
+	for (auto i = 0; i < singular.size(); ++i)
+	{
+		EXPECT_EQ(original->classify(singular.getPoint(i)),
+				loaded->classify(singular.getPoint(i)));
+	}
+}
+
+TEST(ModelFileTests, TreeRoundTrip)
+{
+	const auto filename = std::string{"tree-round-trip-test.model"};
+	auto data = discretize(readHeartDiseaseDataset(
+			"../data/heartDisease.csv"), {0, 3, 4, 7, 9}, 3,
+			BinningMethod::EQUAL_WIDTH).dataset;
+
+	// Train on part of the data, so some of the rest have values the
+	// tree has never seen
+	auto partitions = data.partition(0, 99);
+	auto original = partitions.training.classifier(
+			ClassifierType::DECISION_TREE);
+	saveModel(*original, filename);
+	ASSERT_TRUE(isModelFileReadable(filename));
+	auto loaded = loadModel(filename);
+	std::remove(filename.c_str());
+
+	for (auto i = 0; i < data.size(); ++i)
+	{
+		EXPECT_EQ(original->classify(data.getPoint(i)),
+				loaded->classify(data.getPoint(i)));
+	}
+
+	// Values that aren't whole numbers were never seen either
+	RowVector point = data.getPoint(0);
+	point = point.array() + .5;
+	EXPECT_EQ(NoType, loaded->classify(point));
+}
+
+TEST(ModelFileTests, ThresholdTreeRoundTrip)
+{
+	const auto filename = std::string{"threshold-tree-round-trip-test.model"};
+	auto data = readHeartDiseaseDataset("../data/heartDisease.csv");
+	auto partitions = data.partition(0, 99);
+	auto original = partitions.training.classifier(
+			ClassifierType::THRESHOLD_TREE);
+	saveModel(*original, filename);
+	ASSERT_TRUE(isModelFileReadable(filename));
+	auto loaded = loadModel(filename);
+	std::remove(filename.c_str());
+
+	for (auto i = 0; i < data.size(); ++i)
+	{
+		EXPECT_EQ(original->classify(data.getPoint(i)),
+				loaded->classify(data.getPoint(i)));
+	}
+}
+
+TEST(ModelFileTests, OtherFilesAreNotReadable)
+{
+	EXPECT_FALSE(isModelFileReadable("../data/iris.csv"));
+}
+
+TEST(ModelFileTests, MissingFilesAreNotReadable)
+{
+	EXPECT_FALSE(isModelFileReadable("no-such-file.model"));
+	EXPECT_THROW(loadModel("no-such-file.model"), std::runtime_error);
+}
+
+/**
+ * Overwrites part of a file, to make a broken model out of a good one.
+ */
+template <typename T>
+static void overwrite(const std::string& filename, size_t offset,
+		const T& value)
+{
+	std::fstream file{filename,
+		std::ios::binary | std::ios::in | std::ios::out};
+	file.seekp(offset);
+	file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+TEST(ModelFileTests, RejectsSectionsOutsideTheFile)
+{
+	const auto filename = std::string{"bad-section-test.model"};
+	auto data = readWineDataset("../data/wine.csv");
+	saveModel(*data.classifier(ClassifierType::OPTIMAL), filename);
+	ASSERT_TRUE(isModelFileReadable(filename));
+
+	overwrite(filename, offsetof(ModelFileHeader, numFields),
+			uint64_t{1} << 62);
+	EXPECT_FALSE(isModelFileReadable(filename));
+	EXPECT_THROW(loadModel(filename), std::runtime_error);
+	std::remove(filename.c_str());
+}
+
+TEST(ModelFileTests, RejectsUnknownShapes)
+{
+	const auto filename = std::string{"bad-shape-test.model"};
+	auto data = readWineDataset("../data/wine.csv");
+	saveModel(*data.classifier(ClassifierType::LINEAR), filename);
+	ASSERT_TRUE(isModelFileReadable(filename));
+
+	// Claiming the first class has a full matrix means the whitenings
+	// no longer fit in the file
+	ModelFileHeader header;
+	std::ifstream{filename, std::ios::binary}.read(
+			reinterpret_cast<char*>(&header), sizeof(header));
+	overwrite(filename, header.shapesOffset, uint32_t{0});
+	EXPECT_FALSE(isModelFileReadable(filename));
+
+	overwrite(filename, header.shapesOffset, uint32_t{7});
+	EXPECT_THROW(loadModel(filename), std::runtime_error);
+	std::remove(filename.c_str());
+}
+
+TEST(ModelFileTests, RejectsChildrenThatArentNodes)
+{
+	const auto filename = std::string{"bad-child-test.model"};
+	auto data = readHeartDiseaseDataset("../data/heartDisease.csv");
+	auto tree = data.classifier(ClassifierType::THRESHOLD_TREE);
+	saveModel(*tree, filename);
+	ASSERT_TRUE(isModelFileReadable(filename));
+
+	// The root's first child is the first entry in the child table
+	ModelFileHeader header;
+	std::ifstream{filename, std::ios::binary}.read(
+			reinterpret_cast<char*>(&header), sizeof(header));
+	overwrite(filename, header.childTableOffset,
+			static_cast<uint32_t>(header.numNodes));
+	EXPECT_FALSE(isModelFileReadable(filename));
+	EXPECT_THROW(loadModel(filename), std::runtime_error);
+
+	// Pointing back up the tree would loop forever
+	overwrite(filename, header.childTableOffset, uint32_t{0});
+	EXPECT_THROW(loadModel(filename), std::runtime_error);
+	std::remove(filename.c_str());
+}
+
+TEST(ModelFileTests, OtherClassifiersCantBeSaved)
+{
+	const auto filename = std::string{"forest-test.model"};
+	std::remove(filename.c_str());
+	auto data = readIrisDataset("../data/iris.csv");
+	RandomForest forest{data.getTypes(), data.getData(), 2};
+
+	EXPECT_THROW(saveModel(forest, filename), std::invalid_argument);
+	EXPECT_FALSE(std::ifstream{filename}.is_open());
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "../src/CsvReader.h"
+#include "../src/Dataset.h"
+#include "../src/Preprocessing.h"
+#include <fstream>
+#include <string>
+#include <type_traits>
+
+// Reads one of the covariance matrices R wrote out
+static CovarianceMatrix readCovariance(std::string filename, size_t size)
+{
+	CovarianceMatrix cov{size, size};
+	auto file = std::ifstream{filename};
+	for (auto i = 0; i < size; ++i)
+	{
+		for (auto j = 0; j < size; ++j)
+		{
+			std::string field;
+			std::getline(file, field, j + 1 < size ? ',' : '\n');
+			cov(i, j) = std::stod(field);
+		}
+	}
+	return cov;
+}
+
+TEST(PreprocessingTests, EqualWidthMatchesR)
+{
+	// R worked in doubles. Rounded to floats, points right on a bin's
+	// edge can end up on the other side of it.
+	if (std::is_same<Decimal, float>::value)
+	{
+		GTEST_SKIP();
+	}
+
+	auto iris = discretize(readIrisDataset("../data/iris.csv"),
+			{0, 1, 2, 3}, 3, BinningMethod::EQUAL_WIDTH);
+	EXPECT_TRUE(iris.dataset.getData()
+			== readIrisDataset("../data/irisDiscrete.csv").getData());
+
+	auto heart = discretize(
+			readHeartDiseaseDataset("../data/heartDisease.csv"),
+			{0, 3, 4, 7, 9}, 3, BinningMethod::EQUAL_WIDTH);
+	EXPECT_TRUE(heart.dataset.getData() == readHeartDiseaseDataset(
+			"../data/heartDiseaseDiscrete.csv").getData());
+
+	auto wine = discretize(readWineDataset("../data/wine.csv"),
+			{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12},
+			3, BinningMethod::EQUAL_WIDTH);
+	EXPECT_TRUE(wine.dataset.getData()
+			== readWineDataset("../data/wineDiscrete.csv").getData());
+	EXPECT_TRUE(wine.dataset.getTypes()
+			== readWineDataset("../data/wine.csv").getTypes());
+}
+
+TEST(PreprocessingTests, CovarianceMatchesR)
+{
+	auto wine = discretize(readWineDataset("../data/wine.csv"),
+			{}, 3, BinningMethod::EQUAL_WIDTH);
+	EXPECT_TRUE(wine.covariance.isApprox(readCovariance(
+			"../data/wineCovariance.csv", WineFields), 1e-9));
+
+	auto heart = discretize(
+			readHeartDiseaseDataset("../data/heartDisease.csv"),
+			{0, 3, 4, 7, 9}, 3, BinningMethod::EQUAL_WIDTH);
+	EXPECT_TRUE(heart.covariance.isApprox(readCovariance(
+			"../data/heartDiseaseDiscreteCovariance.csv",
+			HeartDiseaseFields), 1e-9));
+}
+
+TEST(PreprocessingTests, EqualFrequencyBalancesBins)
+{
+	auto wine = discretize(readWineDataset("../data/wine.csv"),
+			{0}, 3, BinningMethod::EQUAL_FREQUENCY);
+	const auto& column = wine.dataset.getData().col(0);
+
+	for (auto bin = 1; bin <= 3; ++bin)
+	{
+		auto count = (column.array() == bin).count();
+		EXPECT_NEAR(178 / 3.0, count, 2);
+	}
+
+	// Columns that weren't selected are left alone
+	EXPECT_TRUE(wine.dataset.getData().rightCols(12)
+			== readWineDataset("../data/wine.csv").getData().rightCols(12));
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include "../src/RandomForest.h"
+#include "../src/CsvReader.h"
+#include "../src/Dataset.h"
+#include "../src/DatasetView.h"
+#include "../src/Types.h"
+#include <sstream>
+
+TEST(RandomForestTests, LearnsTrainingData)
+{
+	auto data = readIrisDataset("../data/iris.csv");
+	RandomForest forest{data.getTypes(), data.getData(), 25};
+
+	auto types = forest.classifyBatch(data.getData());
+	auto numRight = 0;
+	for (auto i = 0; i < data.size(); ++i)
+	{
+		numRight += types[i] == data.getType(i);
+	}
+	EXPECT_GE(numRight, data.size() - 3);
+}
+
+TEST(RandomForestTests, BatchMatchesOneAtATime)
+{
+	auto data = readWineDataset("../data/wine.csv");
+	auto partitions = data.partition(0, 49);
+	RandomForest forest{partitions.training.getTypes(),
+		partitions.training.getData(), 20};
+
+	// More points than fit in one block (the data three times over, and
+	// a bit), and a number of trees that doesn't divide into blocks
+	DataMatrix points(3 * data.size() + 1, data.NumFields);
+	for (auto i = 0; i < points.rows(); ++i)
+	{
+		points.row(i) = data.getPoint(i % data.size());
+	}
+	auto types = forest.classifyBatch(points);
+	ASSERT_EQ(points.rows(), types.rows());
+	for (auto i = 0; i < points.rows(); ++i)
+	{
+		EXPECT_EQ(forest.classify(points.row(i)), types[i]);
+	}
+}
+
+TEST(RandomForestTests, ParallelMatchesSerial)
+{
+	auto data = readHeartDiseaseDataset("../data/heartDisease.csv");
+	RandomForest serial{DatasetView{data}, 12, 1, 7};
+	RandomForest parallel{DatasetView{data}, 12, 4, 7};
+
+	for (auto i = 0; i < serial.NumTrees; ++i)
+	{
+		std::ostringstream serialGraph{};
+		std::ostringstream parallelGraph{};
+		serialGraph << serial.getTree(i);
+		parallelGraph << parallel.getTree(i);
+		EXPECT_EQ(serialGraph.str(), parallelGraph.str());
+	}
+	EXPECT_TRUE(serial.classifyBatch(data.getData())
+			== parallel.classifyBatch(data.getData()));
+}
+
+TEST(RandomForestTests, TreesAreDifferent)
+{
+	auto data = readWineDataset("../data/wine.csv");
+	RandomForest forest{data.getTypes(), data.getData(), 2};
+
+	std::ostringstream first{};
+	std::ostringstream second{};
+	first << forest.getTree(0);
+	second << forest.getTree(1);
+	EXPECT_NE(first.str(), second.str());
+}
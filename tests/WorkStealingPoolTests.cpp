@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "../src/WorkStealingPool.h"
+#include <atomic>
+#include <functional>
+#include <vector>
+
+TEST(WorkStealingPoolTests, RunsEverySpawnedTask)
+{
+	WorkStealingPool pool{4};
+	std::vector<std::atomic<int>> runs(1000);
+	for (auto& count : runs)
+	{
+		count = 0;
+	}
+
+	pool.run([&](size_t worker)
+	{
+		for (auto i = 0; i < runs.size(); ++i)
+		{
+			pool.spawn(worker, [&runs, i](size_t) { ++runs[i]; });
+		}
+	});
+
+	for (const auto& count : runs)
+	{
+		EXPECT_EQ(1, count);
+	}
+}
+
+TEST(WorkStealingPoolTests, RecursiveTasks)
+{
+	// Adds up 1..n by splitting the range in half over and over, with
+	// every half its own task
+	WorkStealingPool pool{3};
+	std::atomic<long> total{0};
+	std::function<void(size_t, long, long)> sum =
+			[&](size_t worker, long first, long last)
+	{
+		if (last - first <= 8)
+		{
+			for (auto i = first; i < last; ++i)
+			{
+				total += i;
+			}
+			return;
+		}
+		auto middle = first + (last - first) / 2;
+		pool.spawn(worker, [&sum, first, middle](size_t w)
+		{
+			sum(w, first, middle);
+		});
+		sum(worker, middle, last);
+	};
+
+	pool.run([&](size_t worker) { sum(worker, 1, 100001); });
+	EXPECT_EQ(5000050000, total);
+}
+
+TEST(WorkStealingPoolTests, WaitForHelps)
+{
+	// One worker can only finish if it runs the tasks it's waiting for
+	// itself
+	WorkStealingPool pool{1};
+	std::atomic<int> done{0};
+
+	pool.run([&](size_t worker)
+	{
+		std::atomic<size_t> pending{10};
+		for (auto i = 0; i < 10; ++i)
+		{
+			pool.spawn(worker, [&pending](size_t) { --pending; });
+		}
+		pool.waitFor(worker, pending);
+		done = 1;
+	});
+
+	EXPECT_EQ(1, done);
+}
+
+TEST(WorkStealingPoolTests, WorkersAreInRange)
+{
+	WorkStealingPool pool{4};
+	std::atomic<bool> inRange{true};
+
+	pool.run([&](size_t worker)
+	{
+		for (auto i = 0; i < 100; ++i)
+		{
+			pool.spawn(worker, [&](size_t taskWorker)
+			{
+				if (taskWorker >= pool.NumWorkers)
+				{
+					inRange = false;
+				}
+			});
+		}
+	});
+
+	EXPECT_TRUE(inRange);
+}